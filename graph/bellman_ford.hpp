@@ -11,6 +11,8 @@
 #include <vector>
 #include <climits>
 #include <iostream>
+#include <stdexcept>
+#include "csr_graph.hpp"
 
 #ifndef ALGORITHMS_BELLMAN_H
 #define ALGORITHMS_BELLMAN_H
@@ -50,4 +52,44 @@ bool bellman_ford(int src, const std::vector<std::vector<std::pair<int, int>>> &
     return false;
 }
 
+/**
+ * The same on weighted graph in CSR form, where every round reads the
+ * arcs as one stream
+ * @param src       source vertex
+ * @param g         graph
+ * @param dist      array of distances
+ * @return          True if a negative weight cycle is detected, otherwise false.
+ */
+bool bellman_ford(int src, const CsrGraph & g, std::vector<int> & dist) {
+    if (!g.weighted()) {
+        throw std::invalid_argument("Graph has no weights");
+    }
+    int n = g.vertices();
+    dist.resize(n, INT_MAX);
+    dist[src] = 0;
+
+    for (int i = 0; i < n - 1; i++) {
+        for (int u = 0; u < n; u++) {
+            if (dist[u] == INT_MAX) continue;
+            for (std::size_t e = g.begin(u); e < g.end(u); e++) {
+                int v = g.target_of(e), weight = g.weight_of(e);
+                if (dist[u] + weight < dist[v]) {
+                    dist[v] = dist[u] + weight;
+                }
+            }
+        }
+    }
+
+    for (int u = 0; u < n; u++) {
+        if (dist[u] == INT_MAX) continue;
+        for (std::size_t e = g.begin(u); e < g.end(u); e++) {
+            if (dist[u] + g.weight_of(e) < dist[g.target_of(e)]) {
+                dist.clear();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 #endif // ALGORITHMS_BELLMAN_H
\ No newline at end of file
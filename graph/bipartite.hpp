@@ -9,6 +9,7 @@
 
 #include <vector>
 #include <queue>
+#include "csr_graph.hpp"
 
 
 #ifndef ALGORITHMS_BIPARTITE_H
@@ -45,5 +46,37 @@ bool is_bipartite(std::vector<std::vector<int>> & adj) {
     return true;
 }
 
+/**
+ * Check if a graph in CSR form is bipartite. The arcs have to be
+ * symmetric, as in the adjacency lists above
+ * @param g         graph
+ * @return          true if the graph is bipartite else false
+ */
+bool is_bipartite(const CsrGraph & g) {
+    int n = g.vertices();
+    std::vector<int> colour(n, 0);
+    std::vector<int> Q;
+    Q.reserve(n);
+    for (int i = 0; i < n; i++) {
+        if (colour[i] != 0)  {
+            continue;
+        }
+        colour[i] = 1;
+        Q.assign(1, i);
+        for (std::size_t head = 0; head < Q.size(); head++) {
+            int u = Q[head];
+            for (int v : g.neighbors(u)) {
+                if (colour[v] == 0) {
+                    Q.push_back(v);
+                    colour[v] = -colour[u];
+                } else if (colour[v] == colour[u]) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
 
 #endif // ALGORITHMS_BIPARTITE_H
\ No newline at end of file
@@ -6,8 +6,11 @@
  * n = |V|, m = |E|
  */
 
+#include <cstddef>
 #include <vector>
 #include <functional>
+#include <utility>
+#include "csr_graph.hpp"
 
 #ifndef ALGORITHMS_CONNECTED_H
 #define ALGORITHMS_CONNECTED_H
@@ -62,4 +65,61 @@ std::vector<int> get_scc(int n, const std::vector<std::vector<int>> & adj) {
     return component;
 }
 
+/**
+ * The same on graph in CSR form. The searches keep an explicit stack of
+ * vertices with the index of their next arc instead of recursing, so the
+ * depth of the graph is not limited by the call stack, and the reversed
+ * graph is built with transpose()
+ * @param g         graph
+ * @return          component number for each vertex
+ */
+std::vector<int> get_scc(const CsrGraph & g) {
+    int n = g.vertices();
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<bool> visited(n, false);
+    std::vector<std::pair<int, std::size_t>> stack;
+    for (int i = 0; i < n; i++) {
+        if (visited[i]) continue;
+        visited[i] = true;
+        stack.emplace_back(i, g.begin(i));
+        while (!stack.empty()) {
+            auto & [u, e] = stack.back();
+            if (e == g.end(u)) {
+                order.push_back(u);
+                stack.pop_back();
+                continue;
+            }
+            int y = g.target_of(e++);
+            if (!visited[y]) {
+                visited[y] = true;
+                stack.emplace_back(y, g.begin(y));
+            }
+        }
+    }
+    CsrGraph rev = g.transpose();
+    std::vector<int> component(n, -1);
+    std::vector<int> todo;
+    int comp = 0;
+    while (!order.empty()) {
+        int x = order.back();
+        order.pop_back();
+        if (component[x] != -1) continue;
+        component[x] = comp;
+        todo.push_back(x);
+        while (!todo.empty()) {
+            int u = todo.back();
+            todo.pop_back();
+            for (int y : rev.neighbors(u)) {
+                if (component[y] == -1) {
+                    component[y] = comp;
+                    todo.push_back(y);
+                }
+            }
+        }
+        comp++;
+    }
+    return component;
+}
+
 #endif // ALGORITHMS_CONNECTED_H
\ No newline at end of file
@@ -0,0 +1,423 @@
+/**
+ * Graph in compressed sparse row form: the arcs of all vertices are
+ * stored in one array of targets (and one of weights, if the graph is
+ * weighted), sorted by source, and offset[u]..offset[u+1] is the range
+ * of the arcs of u. Scanning the arcs of consecutive vertices reads the
+ * arrays as sequential streams, and the whole graph takes three
+ * allocations instead of one per vertex.
+ * The builders place the arcs with a counting sort by source in O(n + m),
+ * keeping the input order of the arcs of each vertex.
+ *
+ * The arrays can also be written to a file as one binary image and mapped
+ * back with mmap: a header followed by the offsets, targets and weights,
+ * each aligned to 64 bytes, which the graph then reads in place. Opening
+ * checks the offsets and targets in one pass over the arrays; a trusted
+ * image can be opened without the check in constant time, and its pages
+ * are loaded on first access. The image uses the byte order of the
+ * machine that wrote it.
+ * n = |V|, m = |E|
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef ALGORITHMS_CSR_GRAPH_H
+#define ALGORITHMS_CSR_GRAPH_H
+
+class CsrGraph {
+    static constexpr char MAGIC[8] = {'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H'};
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr std::size_t ALIGN = 64;
+    static constexpr std::uint64_t NO_ARCS[1] = {0};
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t weighted;
+        std::uint64_t n;
+        std::uint64_t m;
+        std::uint64_t offset_offset;
+        std::uint64_t target_offset;
+        std::uint64_t weight_offset;
+        std::uint64_t image_size;
+    };
+
+    // arrays owned by the graph, empty if it views a mapped image
+    std::vector<std::uint64_t> offset_data;
+    std::vector<int> target_data;
+    std::vector<int> weight_data;
+
+    int n = 0;
+    std::size_t m = 0;
+    const std::uint64_t* offset = NO_ARCS;  // n + 1 entries, offset[n] = m
+    const int* target = nullptr;
+    const int* weight = nullptr;            // nullptr for unweighted graph
+    const unsigned char* image = nullptr;
+    std::size_t mapped_size = 0;
+
+    void bind() {
+        m = target_data.size();
+        offset = offset_data.data();
+        target = target_data.data();
+        weight = weight_data.size() == m && m > 0 ? weight_data.data() : nullptr;
+    }
+
+    /**
+     * @return      true if every target is a vertex in [0, n)
+     */
+    bool targetsInRange() const {
+        return std::all_of(target, target + m, [this](int v) { return 0 <= v && v < n; });
+    }
+
+    static std::size_t alignUp(std::size_t pos) {
+        return (pos + ALIGN - 1) / ALIGN * ALIGN;
+    }
+
+    static Header layout(std::uint64_t n, std::uint64_t m, bool weighted) {
+        Header h{};
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.weighted = weighted;
+        h.n = n;
+        h.m = m;
+        h.offset_offset = alignUp(sizeof(Header));
+        h.target_offset = alignUp(h.offset_offset + (n + 1) * sizeof(std::uint64_t));
+        h.weight_offset = alignUp(h.target_offset + m * sizeof(int));
+        h.image_size = h.weight_offset + (weighted ? m * sizeof(int) : 0);
+        return h;
+    }
+
+    void unmap() {
+        if (mapped_size > 0) {
+            munmap(const_cast<unsigned char*>(image), mapped_size);
+        }
+        image = nullptr;
+        mapped_size = 0;
+    }
+
+    /**
+     * Fill the arrays from m arcs; each(f) calls f(u, v, w) for every arc
+     * from u to v of weight w, in the same order on both calls. The arcs
+     * of u are counted in offset[u + 2], so that after the prefix sums
+     * offset[u + 1] is the start of u and can be advanced while placing
+     * the arcs, ending at the start of u + 1
+     */
+    template <class ForEach>
+    void fill(std::size_t m, ForEach each, bool weighted) {
+        offset_data.assign(static_cast<std::size_t>(n) + 2, 0);
+        each([&](int u, int v, int) {
+            if (u < 0 || u >= n || v < 0 || v >= n) {
+                throw std::invalid_argument("Edge vertex is out of range");
+            }
+            offset_data[u + 2]++;
+        });
+        for (int u = 2; u <= n; u++) {
+            offset_data[u] += offset_data[u - 1];
+        }
+        target_data.resize(m);
+        weight_data.resize(weighted ? m : 0);
+        each([&](int u, int v, int w) {
+            std::uint64_t e = offset_data[u + 1]++;
+            target_data[e] = v;
+            if (weighted) {
+                weight_data[e] = w;
+            }
+        });
+        offset_data.pop_back();
+        bind();
+    }
+
+public:
+    struct Edge {
+        int from;
+        int to;
+        int weight;
+    };
+
+    CsrGraph() = default;
+
+    /**
+     * Build unweighted graph
+     * @param n         number of vertices
+     * @param edges     arcs {u, v} from u to v
+     */
+    CsrGraph(int n, const std::vector<std::pair<int, int>> & edges) : n(n) {
+        fill(edges.size(), [&](auto f) {
+            for (auto [u, v] : edges) {
+                f(u, v, 1);
+            }
+        }, false);
+    }
+
+    /**
+     * Build weighted graph
+     * @param n         number of vertices
+     * @param edges     arcs {u, v, w} from u to v of weight w
+     */
+    CsrGraph(int n, const std::vector<Edge> & edges) : n(n) {
+        fill(edges.size(), [&](auto f) {
+            for (const Edge & e : edges) {
+                f(e.from, e.to, e.weight);
+            }
+        }, true);
+    }
+
+    /**
+     * Convert adjacency lists of unweighted graph
+     */
+    explicit CsrGraph(const std::vector<std::vector<int>> & adj) : n(static_cast<int>(adj.size())) {
+        offset_data.resize(n + 1, 0);
+        for (int u = 0; u < n; u++) {
+            offset_data[u + 1] = offset_data[u] + adj[u].size();
+        }
+        target_data.reserve(offset_data[n]);
+        for (auto & arcs : adj) {
+            target_data.insert(target_data.end(), arcs.begin(), arcs.end());
+        }
+        bind();
+        if (!targetsInRange()) {
+            throw std::invalid_argument("Edge vertex is out of range");
+        }
+    }
+
+    /**
+     * Convert adjacency lists {v, w} of weighted graph
+     */
+    explicit CsrGraph(const std::vector<std::vector<std::pair<int, int>>> & adj) : n(static_cast<int>(adj.size())) {
+        offset_data.resize(n + 1, 0);
+        for (int u = 0; u < n; u++) {
+            offset_data[u + 1] = offset_data[u] + adj[u].size();
+        }
+        target_data.reserve(offset_data[n]);
+        weight_data.reserve(offset_data[n]);
+        for (auto & arcs : adj) {
+            for (auto [v, w] : arcs) {
+                target_data.push_back(v);
+                weight_data.push_back(w);
+            }
+        }
+        bind();
+        if (!targetsInRange()) {
+            throw std::invalid_argument("Edge vertex is out of range");
+        }
+    }
+
+    /**
+     * Take arrays built by the caller, e.g. a loader
+     * @param offsets   n + 1 nondecreasing offsets from 0 to m
+     * @param targets   m targets in [0, n)
+     * @param weights   m weights, or none for unweighted graph
+     */
+    CsrGraph(std::vector<std::uint64_t> && offsets, std::vector<int> && targets, std::vector<int> && weights = {})
+        : offset_data(std::move(offsets)), target_data(std::move(targets)), weight_data(std::move(weights)) {
+        if (offset_data.empty() || offset_data.size() - 1 > static_cast<std::size_t>(INT32_MAX) ||
+            offset_data[0] != 0 || offset_data.back() != target_data.size() ||
+            (!weight_data.empty() && weight_data.size() != target_data.size())) {
+            throw std::invalid_argument("CSR arrays do not match");
+        }
+        for (std::size_t u = 1; u < offset_data.size(); u++) {
+            if (offset_data[u] < offset_data[u - 1]) {
+                throw std::invalid_argument("CSR arrays do not match");
+            }
+        }
+        n = static_cast<int>(offset_data.size() - 1);
+        bind();
+        if (!targetsInRange()) {
+            throw std::invalid_argument("Edge vertex is out of range");
+        }
+    }
+
+    CsrGraph(const CsrGraph &) = delete;
+    CsrGraph& operator=(const CsrGraph &) = delete;
+    CsrGraph(CsrGraph && g) noexcept : CsrGraph() {
+        swap(g);
+    }
+    CsrGraph& operator=(CsrGraph && g) noexcept {
+        swap(g);
+        return *this;
+    }
+    ~CsrGraph() {
+        unmap();
+    }
+
+    /**
+     * The pointers keep pointing into the swapped vectors
+     */
+    void swap(CsrGraph & g) noexcept {
+        std::swap(offset_data, g.offset_data);
+        std::swap(target_data, g.target_data);
+        std::swap(weight_data, g.weight_data);
+        std::swap(n, g.n);
+        std::swap(m, g.m);
+        std::swap(offset, g.offset);
+        std::swap(target, g.target);
+        std::swap(weight, g.weight);
+        std::swap(image, g.image);
+        std::swap(mapped_size, g.mapped_size);
+    }
+
+    int vertices() const {
+        return n;
+    }
+
+    std::size_t edges() const {
+        return m;
+    }
+
+    bool weighted() const {
+        return m == 0 || weight != nullptr;
+    }
+
+    /**
+     * @return      index of the first arc of u
+     */
+    std::size_t begin(int u) const {
+        return offset[u];
+    }
+
+    /**
+     * @return      index past the last arc of u
+     */
+    std::size_t end(int u) const {
+        return offset[u + 1];
+    }
+
+    int degree(int u) const {
+        return static_cast<int>(offset[u + 1] - offset[u]);
+    }
+
+    int target_of(std::size_t e) const {
+        return target[e];
+    }
+
+    int weight_of(std::size_t e) const {
+        return weight[e];
+    }
+
+    /**
+     * @return      targets of the arcs of u
+     */
+    std::span<const int> neighbors(int u) const {
+        return { target + offset[u], target + offset[u + 1] };
+    }
+
+    /**
+     * @return      weights of the arcs of u, in the order of neighbors(u)
+     */
+    std::span<const int> weights(int u) const {
+        return { weight + offset[u], weight + offset[u + 1] };
+    }
+
+    /**
+     * @return      graph with every arc reversed, with the same weights
+     */
+    CsrGraph transpose() const {
+        CsrGraph result;
+        result.n = n;
+        bool weighted = weight != nullptr;
+        result.fill(m, [&](auto f) {
+            for (int u = 0; u < n; u++) {
+                for (std::uint64_t e = offset[u]; e < offset[u + 1]; e++) {
+                    f(target[e], u, weighted ? weight[e] : 1);
+                }
+            }
+        }, weighted);
+        return result;
+    }
+
+    /**
+     * Write the binary image of the graph to a file
+     * @param path
+     */
+    void write(const std::string & path) const {
+        Header h = layout(n, m, weight != nullptr);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        const char padding[ALIGN] = {};
+        std::uint64_t pos = 0;
+        auto put = [&](const void* data, std::size_t bytes, std::uint64_t end) {
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            out.write(padding, static_cast<std::streamsize>(end - pos - bytes));
+            pos = end;
+        };
+        put(&h, sizeof(Header), h.offset_offset);
+        put(offset, (n + 1) * sizeof(std::uint64_t), h.target_offset);
+        put(target, m * sizeof(int), h.weight_offset);
+        if (weight != nullptr) {
+            put(weight, m * sizeof(int), h.image_size);
+        }
+        if (!out) {
+            throw std::runtime_error("Cannot write graph to " + path);
+        }
+    }
+
+    /**
+     * Map the image of a graph from a file read-only into memory
+     * @param path
+     * @param validate  check in O(n + m) that the offsets are nondecreasing
+     *                  and all targets are in [0, n); without it only the
+     *                  header and the first and last offsets are checked,
+     *                  and a corrupted image can make the graph read out
+     *                  of bounds
+     * @return          the graph, valid until it is destroyed
+     */
+    static CsrGraph open(const std::string & path, bool validate = true) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open graph " + path);
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot read graph " + path);
+        }
+        auto size = static_cast<std::size_t>(st.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Cannot map graph " + path);
+        }
+        CsrGraph g;
+        g.image = static_cast<const unsigned char*>(data);
+        g.mapped_size = size;
+        Header h;
+        if (size < sizeof(Header)) {
+            throw std::runtime_error("Graph image is truncated");
+        }
+        std::memcpy(&h, data, sizeof(Header));
+        if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION) {
+            throw std::runtime_error("Not a graph image");
+        }
+        Header expected = layout(h.n, h.m, h.weighted);
+        if (h.n > static_cast<std::uint64_t>(INT32_MAX) || h.weighted > 1 ||
+            h.offset_offset != expected.offset_offset || h.target_offset != expected.target_offset ||
+            h.weight_offset != expected.weight_offset || h.image_size != expected.image_size || size < h.image_size) {
+            throw std::runtime_error("Graph image is corrupted");
+        }
+        g.n = static_cast<int>(h.n);
+        g.m = h.m;
+        g.offset = reinterpret_cast<const std::uint64_t*>(g.image + h.offset_offset);
+        g.target = reinterpret_cast<const int*>(g.image + h.target_offset);
+        g.weight = h.weighted ? reinterpret_cast<const int*>(g.image + h.weight_offset) : nullptr;
+        if (g.offset[0] != 0 || g.offset[g.n] != g.m) {
+            throw std::runtime_error("Graph image is corrupted");
+        }
+        if (validate && (!std::is_sorted(g.offset, g.offset + g.n + 1) || !g.targetsInRange())) {
+            throw std::runtime_error("Graph image is corrupted");
+        }
+        return g;
+    }
+};
+
+#endif // ALGORITHMS_CSR_GRAPH_H
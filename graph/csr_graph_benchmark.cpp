@@ -0,0 +1,153 @@
+#include "bipartite.hpp"
+#include "connected_components.hpp"
+#include "csr_graph.hpp"
+#include "dijkstra.hpp"
+#include "topological_sort.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using Graph = std::vector<std::vector<std::pair<int, int>>>;
+
+std::size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void report(const std::string & name, Clock::time_point start, std::size_t allocations_before) {
+    double ms = elapsed_ms(start);
+    std::cout << "  " << name << ": " << ms << " ms, " << allocations - allocations_before << " allocations"
+              << std::endl;
+}
+
+/**
+ * Build the graph of m random arcs on n vertices as adjacency lists and
+ * in CSR form, then run the same algorithms on both. The arcs from u to
+ * v > u form a DAG for toposort, and for is_bipartite every arc joins an
+ * even and an odd vertex in both directions, so the whole graph is
+ * searched.
+ */
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    std::size_t m = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10 * static_cast<std::size_t>(n);
+    std::mt19937_64 gen(2024);
+    std::vector<CsrGraph::Edge> edges(m);
+    for (auto & e : edges) {
+        e = { static_cast<int>(gen() % n), static_cast<int>(gen() % n), static_cast<int>(gen() % 1000) };
+    }
+    std::cout << "Random graph: " << n << " vertices, " << m << " arcs" << std::endl;
+
+    std::cout << "Build from edge list" << std::endl;
+    std::size_t before = allocations;
+    auto start = Clock::now();
+    Graph adj(n);
+    for (auto & e : edges) {
+        adj[e.from].emplace_back(e.to, e.weight);
+    }
+    report("adjacency lists", start, before);
+    before = allocations;
+    start = Clock::now();
+    CsrGraph g(n, edges);
+    report("CsrGraph", start, before);
+
+    std::cout << "Sum of weights over all arcs" << std::endl;
+    std::int64_t sum_adj = 0, sum_csr = 0;
+    start = Clock::now();
+    for (auto & arcs : adj) {
+        for (auto [v, w] : arcs) sum_adj += w;
+    }
+    report("adjacency lists", start, allocations);
+    start = Clock::now();
+    for (int u = 0; u < n; u++) {
+        for (int w : g.weights(u)) sum_csr += w;
+    }
+    report("CsrGraph", start, allocations);
+
+    std::cout << "Dijkstra from vertex 0" << std::endl;
+    std::vector<int> dist_adj, dist_csr;
+    before = allocations;
+    start = Clock::now();
+    dijkstra(0, adj, dist_adj);
+    report("adjacency lists", start, before);
+    before = allocations;
+    start = Clock::now();
+    dijkstra(0, g, dist_csr);
+    report("CsrGraph", start, before);
+    adj = Graph();
+
+    std::cout << "Strongly connected components" << std::endl;
+    before = allocations;
+    start = Clock::now();
+    std::vector<int> components = get_scc(g);
+    report("CsrGraph (the recursive adjacency lists version would overflow the stack)", start, before);
+
+    std::vector<std::vector<int>> dag(n), sym(n);
+    std::vector<std::pair<int, int>> dag_edges, sym_edges;
+    for (auto & e : edges) {
+        if (e.from == e.to) continue;
+        int u = std::min(e.from, e.to), v = std::max(e.from, e.to);
+        dag[u].push_back(v);
+        dag_edges.emplace_back(u, v);
+    }
+    for (auto & e : edges) {
+        int u = e.from & ~1, v = e.to | 1;
+        if (v >= n) continue;
+        sym[u].push_back(v);
+        sym[v].push_back(u);
+        sym_edges.emplace_back(u, v);
+        sym_edges.emplace_back(v, u);
+    }
+    std::cout << "Topological sort of the DAG" << std::endl;
+    std::vector<std::vector<int>> sorted_adj, sorted_csr;
+    before = allocations;
+    start = Clock::now();
+    toposort(sorted_adj, dag);
+    report("adjacency lists", start, before);
+    CsrGraph g_dag(n, dag_edges);
+    before = allocations;
+    start = Clock::now();
+    toposort(sorted_csr, g_dag);
+    report("CsrGraph", start, before);
+    dag = decltype(dag)();
+    g_dag = CsrGraph();
+
+    std::cout << "Bipartite check of the symmetric graph" << std::endl;
+    before = allocations;
+    start = Clock::now();
+    bool bipartite_adj = is_bipartite(sym);
+    report("adjacency lists", start, before);
+    CsrGraph g_sym(n, sym_edges);
+    before = allocations;
+    start = Clock::now();
+    bool bipartite_csr = is_bipartite(g_sym);
+    report("CsrGraph", start, before);
+
+    if (sum_adj != sum_csr || dist_adj != dist_csr || sorted_adj != sorted_csr || bipartite_adj != bipartite_csr) {
+        std::cout << "  results differ!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,39 +1,77 @@
 /**
  * The Dijkstra's algorithm to compute distances from the source to all vertices
- * in weighted graph without negative edges.
- * Time complexity: O(n*log n + n)
+ * in weighted graph without negative edges. The queue is an addressable heap
+ * holding each vertex at most once, whose distance is decreased in place.
+ * Time complexity: O((n + m) * log n)
  * n = |V|, m = |E|
  */
 
 #include <climits>
-#include <unordered_map>
+#include <functional>
+#include <stdexcept>
 #include <vector>
-#include <queue>
+#include "csr_graph.hpp"
+#include "../structures/indexed_heap.hpp"
 
 #ifndef ALGORITHMS_DIJKSTRA_H
 #define ALGORITHMS_DIJKSTRA_H
 
 void dijkstra(int src, const std::vector<std::vector<std::pair<int, int>>> & adj, std::vector<int> & dist) {
     int n = static_cast<int>(adj.size());
-    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<>> Q;
+    IndexedHeap<std::pair<int, int>, std::greater<>> Q(n);
+    std::vector<int> handle(n, -1);
 
     dist.resize(n, INT_MAX);
-    Q.emplace(0, src);
     dist[src] = 0;
+    handle[src] = Q.insert({0, src});
 
     while (!Q.empty()) {
-        auto p = Q.top();
-        Q.pop();
-        int u = p.second, d = p.first;
-        if (dist[u] != INT_MAX && d != dist[u]) continue;
+        auto [d, u] = Q.pop();
+        handle[u] = -1;
         for (auto q : adj[u]) {
             int v = q.first, w = q.second;
             if (dist[v] > d + w) {
                 dist[v] = d + w;
-                Q.emplace(dist[v], v);
+                if (handle[v] >= 0) {
+                    Q.decrease_key(handle[v], {dist[v], v});
+                } else {
+                    handle[v] = Q.insert({dist[v], v});
+                }
             }
         }
     }
 }
 
-#endif // ALGORITHMS_DIJKSTRA_H
\ No newline at end of file
+/**
+ * The same on weighted graph in CSR form
+ */
+void dijkstra(int src, const CsrGraph & g, std::vector<int> & dist) {
+    if (!g.weighted()) {
+        throw std::invalid_argument("Graph has no weights");
+    }
+    int n = g.vertices();
+    IndexedHeap<std::pair<int, int>, std::greater<>> Q(n);
+    std::vector<int> handle(n, -1);
+
+    dist.resize(n, INT_MAX);
+    dist[src] = 0;
+    handle[src] = Q.insert({0, src});
+
+    while (!Q.empty()) {
+        auto [d, u] = Q.pop();
+        handle[u] = -1;
+        for (std::size_t e = g.begin(u); e < g.end(u); e++) {
+            int v = g.target_of(e), w = g.weight_of(e);
+            if (dist[v] > d + w) {
+                dist[v] = d + w;
+                if (handle[v] >= 0) {
+                    Q.decrease_key(handle[v], {dist[v], v});
+                } else {
+                    handle[v] = Q.insert({dist[v], v});
+                }
+            }
+        }
+    }
+}
+
+#endif // ALGORITHMS_DIJKSTRA_H
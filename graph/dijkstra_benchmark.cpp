@@ -0,0 +1,107 @@
+#include "dijkstra.hpp"
+
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using Graph = std::vector<std::vector<std::pair<int, int>>>;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * Road-like graph: a side x side grid with random travel times in both
+ * directions, about a tenth of the streets missing and a few fast long
+ * roads between random crossings
+ */
+Graph make_roads(int side, std::mt19937 & gen) {
+    int n = side * side;
+    Graph adj(n);
+    std::uniform_int_distribution<int> weight(10, 100), vertex(0, n - 1);
+    std::bernoulli_distribution missing(0.1);
+    auto add = [&](int u, int v, int w) {
+        adj[u].emplace_back(v, w);
+        adj[v].emplace_back(u, w);
+    };
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            int u = r * side + c;
+            if (c + 1 < side && !missing(gen)) add(u, u + 1, weight(gen));
+            if (r + 1 < side && !missing(gen)) add(u, u + side, weight(gen));
+        }
+    }
+    for (int i = 0; i < n / 100; i++) {
+        add(vertex(gen), vertex(gen), 5 * weight(gen));
+    }
+    return adj;
+}
+
+/**
+ * The previous implementation: std::priority_queue with lazy deletion
+ * of outdated entries
+ * @return      the largest number of entries in the queue
+ */
+std::size_t dijkstra_lazy(int src, const Graph & adj, std::vector<int> & dist) {
+    int n = static_cast<int>(adj.size());
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<>> Q;
+    std::size_t peak = 1;
+    dist.assign(n, INT_MAX);
+    Q.emplace(0, src);
+    dist[src] = 0;
+    while (!Q.empty()) {
+        auto [d, u] = Q.top();
+        Q.pop();
+        if (d != dist[u]) continue;
+        for (auto [v, w] : adj[u]) {
+            if (dist[v] > d + w) {
+                dist[v] = d + w;
+                Q.emplace(dist[v], v);
+                peak = std::max(peak, Q.size());
+            }
+        }
+    }
+    return peak;
+}
+
+int main(int argc, char* argv[]) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int sources = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::mt19937 gen(2024);
+    Graph adj = make_roads(side, gen);
+    std::size_t m = 0;
+    for (auto & edges : adj) m += edges.size();
+    std::cout << "Road-like grid: " << adj.size() << " vertices, " << m << " arcs, "
+              << sources << " sources" << std::endl;
+
+    std::uniform_int_distribution<int> vertex(0, side * side - 1);
+    std::vector<int> src(sources);
+    for (auto & s : src) s = vertex(gen);
+
+    std::vector<int> dist_lazy, dist;
+    std::size_t peak = 0;
+    auto start = Clock::now();
+    for (int s : src) {
+        peak = std::max(peak, dijkstra_lazy(s, adj, dist_lazy));
+    }
+    std::cout << "  lazy deletion (std::priority_queue): " << elapsed_ms(start) / sources
+              << " ms per source, peak queue " << peak << " entries" << std::endl;
+
+    start = Clock::now();
+    for (int s : src) {
+        dist.clear();
+        dijkstra(s, adj, dist);
+    }
+    std::cout << "  decrease-key (IndexedHeap): " << elapsed_ms(start) / sources
+              << " ms per source, at most one entry per vertex" << std::endl;
+    if (dist != dist_lazy) {
+        std::cout << "  distances differ!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
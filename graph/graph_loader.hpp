@@ -0,0 +1,362 @@
+/**
+ * Loaders of edge lists in text formats into CsrGraph.
+ *  - SNAP: an arc "u v" per line, vertices numbered from 0, comment lines
+ *    start with '#' or '%' and further columns are ignored. The number of
+ *    vertices is the largest vertex + 1.
+ *  - DIMACS (shortest paths challenge): a problem line "p sp n m", arcs
+ *    "a u v w" with vertices numbered from 1 and comment lines "c".
+ * The file is mapped with mmap and cut at line boundaries into a piece per
+ * thread. The threads parse their pieces in passes, finding the largest
+ * vertex (SNAP only), counting the degrees and placing the arcs, and count
+ * and place through std::atomic_ref on the shared offsets, so no edge list
+ * is built: the graph arrays are the only memory allocated, and the file
+ * is read as a stream from the page cache. As the threads place the arcs
+ * of a vertex in any order, the arcs of every vertex are sorted by target
+ * (and weight) at the end, so the graph does not depend on the number of
+ * threads.
+ * Time complexity: O(s / t + m log d), s = size of the file, t = threads,
+ * d = largest degree
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "csr_graph.hpp"
+
+#ifndef ALGORITHMS_GRAPH_LOADER_H
+#define ALGORITHMS_GRAPH_LOADER_H
+
+namespace graph_loader {
+
+/**
+ * Text file mapped read-only for sequential reading
+ */
+class MappedFile {
+    const char* text = nullptr;
+    std::size_t length = 0;
+
+public:
+    explicit MappedFile(const std::string & path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open graph file " + path);
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot read graph file " + path);
+        }
+        length = static_cast<std::size_t>(st.st_size);
+        if (length > 0) {
+            void* data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map graph file " + path);
+            }
+            madvise(data, length, MADV_SEQUENTIAL);
+            text = static_cast<const char*>(data);
+        }
+        ::close(fd);
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile& operator=(const MappedFile &) = delete;
+    ~MappedFile() {
+        if (length > 0) {
+            munmap(const_cast<char*>(text), length);
+        }
+    }
+
+    const char* begin() const {
+        return text;
+    }
+
+    const char* end() const {
+        return text + length;
+    }
+};
+
+using Piece = std::pair<const char*, const char*>;
+
+/**
+ * Cut [begin, end) into parts pieces, each ending after a newline
+ */
+inline std::vector<Piece> split(const char* begin, const char* end, int parts) {
+    std::vector<Piece> pieces;
+    const char* from = begin;
+    for (int i = 1; i <= parts; i++) {
+        const char* to = i == parts ? end : begin + (end - begin) * i / parts;
+        if (to < from) to = from;
+        if (to != end) {
+            const char* eol = static_cast<const char*>(std::memchr(to, '\n', end - to));
+            to = eol ? eol + 1 : end;
+        }
+        pieces.emplace_back(from, to);
+        from = to;
+    }
+    return pieces;
+}
+
+/**
+ * Call f(i) for i in [0, count) on a thread each, the first exception
+ * thrown is rethrown after all threads finish
+ */
+template <class F>
+void runParallel(std::size_t count, F f) {
+    if (count == 1) {
+        f(0);
+        return;
+    }
+    std::vector<std::exception_ptr> errors(count);
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < count; i++) {
+        workers.emplace_back([&f, &errors, i]() {
+            try {
+                f(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto & w : workers) {
+        w.join();
+    }
+    for (auto & e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+}
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p;
+}
+
+/**
+ * Parse an integer in the range of int after blanks
+ * @return      false if there is none
+ */
+inline bool readInt(const char* & p, const char* end, long long & x) {
+    p = skipBlanks(p, end);
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) p++;
+    if (p == end || *p < '0' || *p > '9') return false;
+    long long value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p++ - '0');
+        if (value > INT32_MAX) return false;
+    }
+    x = negative ? -value : value;
+    return true;
+}
+
+/**
+ * Call line(begin, end) for every line of the piece, without the newline
+ */
+template <class F>
+void forEachLine(const Piece & piece, F line) {
+    const char* p = piece.first;
+    while (p < piece.second) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', piece.second - p));
+        if (eol == nullptr) eol = piece.second;
+        line(p, eol);
+        p = eol == piece.second ? eol : eol + 1;
+    }
+}
+
+[[noreturn]] inline void malformed(const char* begin, const char* end) {
+    throw std::runtime_error("Malformed line in graph file: " + std::string(begin, end));
+}
+
+/**
+ * Call f(u, v, 1) for every arc of a SNAP piece
+ */
+template <class F>
+void snapArcs(const Piece & piece, F f) {
+    forEachLine(piece, [&](const char* begin, const char* end) {
+        const char* p = skipBlanks(begin, end);
+        if (p == end || *p == '#' || *p == '%') return;
+        long long u, v;
+        if (!readInt(p, end, u) || !readInt(p, end, v) || u < 0 || v < 0) {
+            malformed(begin, end);
+        }
+        f(static_cast<int>(u), static_cast<int>(v), 1);
+    });
+}
+
+/**
+ * Call f(u, v, w) for every arc of a DIMACS piece, numbered from 0
+ */
+template <class F>
+void dimacsArcs(const Piece & piece, int n, F f) {
+    forEachLine(piece, [&](const char* begin, const char* end) {
+        const char* p = skipBlanks(begin, end);
+        if (p == end || *p == 'c' || *p == 'p') return;
+        long long u, v, w;
+        if (*p != 'a' || !readInt(++p, end, u) || !readInt(p, end, v) || !readInt(p, end, w) ||
+            u < 1 || u > n || v < 1 || v > n) {
+            malformed(begin, end);
+        }
+        f(static_cast<int>(u - 1), static_cast<int>(v - 1), static_cast<int>(w));
+    });
+}
+
+struct Arc {
+    int u, v, w;
+    std::uint64_t e;
+};
+
+/**
+ * Call flush(batch) for the arcs given by each(piece, f) of every piece
+ * in parallel, a batch of up to BATCH arcs at a time. Parsing a line is a
+ * long chain of dependent instructions, so an access to the offsets of a
+ * random vertex after every line would miss the cache alone; a batch lets
+ * the misses overlap
+ */
+template <class ForEachArc, class Flush>
+void forEachBatch(const std::vector<Piece> & pieces, ForEachArc each, Flush flush) {
+    constexpr std::size_t BATCH = 4096;
+    runParallel(pieces.size(), [&](std::size_t i) {
+        std::vector<Arc> batch;
+        batch.reserve(BATCH);
+        each(pieces[i], [&](int u, int v, int w) {
+            batch.push_back({ u, v, w, 0 });
+            if (batch.size() == BATCH) {
+                flush(batch);
+                batch.clear();
+            }
+        });
+        flush(batch);
+    });
+}
+
+/**
+ * Count and place the arcs given by each(piece, f) for all pieces in
+ * parallel, then sort the arcs of every vertex. The positions of a batch
+ * are all taken before any arc is written, as every locked fetch_add
+ * would wait for the pending writes
+ */
+template <class ForEachArc>
+CsrGraph build(const std::vector<Piece> & pieces, int n, bool weighted, ForEachArc each) {
+    std::vector<std::uint64_t> offsets(static_cast<std::size_t>(n) + 2, 0);
+    forEachBatch(pieces, each, [&](std::vector<Arc> & batch) {
+        for (const Arc & a : batch) {
+            std::atomic_ref<std::uint64_t>(offsets[a.u + 2]).fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    for (std::size_t u = 2; u < offsets.size(); u++) {
+        offsets[u] += offsets[u - 1];
+    }
+    std::vector<int> targets(offsets.back()), weights(weighted ? targets.size() : 0);
+    forEachBatch(pieces, each, [&](std::vector<Arc> & batch) {
+        for (const Arc & a : batch) {
+            __builtin_prefetch(&offsets[a.u + 1], 1);
+        }
+        for (Arc & a : batch) {
+            a.e = std::atomic_ref<std::uint64_t>(offsets[a.u + 1]).fetch_add(1, std::memory_order_relaxed);
+        }
+        for (const Arc & a : batch) {
+            targets[a.e] = a.v;
+            if (weighted) {
+                weights[a.e] = a.w;
+            }
+        }
+    });
+    offsets.pop_back();
+
+    runParallel(pieces.size(), [&](std::size_t i) {
+        std::vector<std::pair<int, int>> arcs;
+        int from = static_cast<int>(static_cast<long long>(n) * i / pieces.size());
+        int to = static_cast<int>(static_cast<long long>(n) * (i + 1) / pieces.size());
+        for (int u = from; u < to; u++) {
+            auto b = static_cast<std::ptrdiff_t>(offsets[u]), e = static_cast<std::ptrdiff_t>(offsets[u + 1]);
+            if (!weighted) {
+                std::sort(targets.begin() + b, targets.begin() + e);
+                continue;
+            }
+            arcs.clear();
+            for (auto k = b; k < e; k++) {
+                arcs.emplace_back(targets[k], weights[k]);
+            }
+            std::sort(arcs.begin(), arcs.end());
+            for (auto k = b; k < e; k++) {
+                std::tie(targets[k], weights[k]) = arcs[k - b];
+            }
+        }
+    });
+    return CsrGraph(std::move(offsets), std::move(targets), std::move(weights));
+}
+
+} // namespace graph_loader
+
+/**
+ * Load unweighted graph from a SNAP edge list
+ * @param path
+ * @param threads   number of threads parsing the file
+ * @return          the graph
+ */
+CsrGraph read_snap(const std::string & path, int threads = 1) {
+    using namespace graph_loader;
+    MappedFile file(path);
+    auto pieces = split(file.begin(), file.end(), std::max(threads, 1));
+    std::vector<long long> largest(pieces.size(), -1);
+    runParallel(pieces.size(), [&](std::size_t i) {
+        snapArcs(pieces[i], [&](int u, int v, int) {
+            largest[i] = std::max<long long>(largest[i], std::max(u, v));
+        });
+    });
+    long long n = *std::max_element(largest.begin(), largest.end()) + 1;
+    if (n > INT32_MAX) {
+        throw std::length_error("Graph has too many vertices");
+    }
+    return build(pieces, static_cast<int>(n), false, [](const Piece & piece, auto f) {
+        snapArcs(piece, f);
+    });
+}
+
+/**
+ * Load weighted graph from a DIMACS shortest paths file
+ * @param path
+ * @param threads   number of threads parsing the file
+ * @return          the graph, with vertices numbered from 0
+ */
+CsrGraph read_dimacs(const std::string & path, int threads = 1) {
+    using namespace graph_loader;
+    MappedFile file(path);
+    long long n = -1;
+    for (const char* begin = file.begin(); begin < file.end() && n < 0; ) {
+        const char* end = static_cast<const char*>(std::memchr(begin, '\n', file.end() - begin));
+        if (end == nullptr) end = file.end();
+        const char* p = skipBlanks(begin, end);
+        if (p < end && *p == 'a') break;
+        if (p < end && *p == 'p') {
+            p = skipBlanks(p + 1, end);
+            while (p < end && *p != ' ' && *p != '\t') p++;    // problem type, "sp"
+            long long m;
+            if (!readInt(p, end, n) || !readInt(p, end, m) || n < 0) {
+                malformed(begin, end);
+            }
+        }
+        begin = end == file.end() ? end : end + 1;
+    }
+    if (n < 0) {
+        throw std::runtime_error("DIMACS file has no problem line: " + path);
+    }
+    auto pieces = split(file.begin(), file.end(), std::max(threads, 1));
+    return build(pieces, static_cast<int>(n), true, [n](const Piece & piece, auto f) {
+        dimacsArcs(piece, static_cast<int>(n), f);
+    });
+}
+
+#endif // ALGORITHMS_GRAPH_LOADER_H
@@ -0,0 +1,120 @@
+#include "csr_graph.hpp"
+#include "graph_loader.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * Read every arc once, which faults in all pages of a mapped graph
+ */
+std::uint64_t scan(const CsrGraph & g) {
+    std::uint64_t total = 0;
+    for (int u = 0; u < g.vertices(); u++) {
+        for (int v : g.neighbors(u)) total += v;
+    }
+    return total;
+}
+
+/**
+ * The parsing of parallel/shortest_path.cu: a string stream per line
+ * into an edge list, which is then built into the graph
+ */
+CsrGraph read_lines(const std::string & path) {
+    std::ifstream in(path);
+    std::vector<std::pair<int, int>> edges;
+    std::string line;
+    int n = 0;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream istr(line);
+        int x, y;
+        if (istr >> x >> y) {
+            edges.emplace_back(x, y);
+            n = std::max(n, std::max(x, y) + 1);
+        }
+    }
+    return CsrGraph(n, edges);
+}
+
+/**
+ * Write a SNAP file of m random arcs on n vertices, load it as text in
+ * several ways, then write the binary image and map it back
+ */
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    std::size_t m = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10 * static_cast<std::size_t>(n);
+    auto dir = std::filesystem::temp_directory_path();
+    std::string snap = (dir / "graph_loader_benchmark.snap").string();
+    std::string image = (dir / "graph_loader_benchmark.bin").string();
+    {
+        std::mt19937_64 gen(2024);
+        std::ofstream out(snap);
+        out << "# Random directed graph\n# Nodes: " << n << " Edges: " << m << "\n";
+        std::string buffer;
+        for (std::size_t i = 0; i < m; i++) {
+            buffer += std::to_string(gen() % n);
+            buffer += '\t';
+            buffer += std::to_string(gen() % n);
+            buffer += '\n';
+            if (buffer.size() > (1 << 20)) {
+                out << buffer;
+                buffer.clear();
+            }
+        }
+        out << buffer;
+    }
+    std::cout << "SNAP file: " << n << " vertices, " << m << " arcs, "
+              << std::filesystem::file_size(snap) / (1 << 20) << " MB" << std::endl;
+
+    auto start = Clock::now();
+    std::uint64_t expected = scan(read_lines(snap));
+    std::cout << "  getline + istringstream + CsrGraph(n, edges): " << elapsed_ms(start) << " ms" << std::endl;
+    for (int threads : {1, 2, 4}) {
+        start = Clock::now();
+        CsrGraph g = read_snap(snap, threads);
+        double ms = elapsed_ms(start);
+        std::cout << "  read_snap, " << threads << " threads: " << ms << " ms"
+                  << (scan(g) == expected ? "" : " (different graph!)") << std::endl;
+        if (threads == 1) {
+            start = Clock::now();
+            g.write(image);
+            std::cout << "  write binary image: " << elapsed_ms(start) << " ms, "
+                      << std::filesystem::file_size(image) / (1 << 20) << " MB" << std::endl;
+        }
+    }
+
+    // without validation, so that the first scan pays for the page faults
+    start = Clock::now();
+    CsrGraph mapped = CsrGraph::open(image, false);
+    double open_ms = elapsed_ms(start);
+    start = Clock::now();
+    bool same = scan(mapped) == expected;
+    double scan_ms = elapsed_ms(start);
+    std::cout << "  open binary image without validation: " << open_ms << " ms, first scan of all arcs "
+              << scan_ms << " ms" << (same ? "" : " (different graph!)") << std::endl;
+    start = Clock::now();
+    same = scan(mapped) == expected;
+    std::cout << "  second scan: " << elapsed_ms(start) << " ms" << (same ? "" : " (different graph!)") << std::endl;
+    start = Clock::now();
+    CsrGraph validated = CsrGraph::open(image);
+    std::cout << "  open binary image with validation (pages cached): " << elapsed_ms(start) << " ms" << std::endl;
+    std::filesystem::remove(snap);
+    std::filesystem::remove(image);
+    return 0;
+}
@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <queue>
+#include "csr_graph.hpp"
 
 #ifndef ALGORITHMS_TOPOSORT_H
 #define ALGORITHMS_TOPOSORT_H
@@ -53,4 +54,46 @@ bool toposort(std::vector<std::vector<int>> & sorted, const std::vector<std::vec
     return visit_counter == n;
 }
 
+/**
+ * The same on graph in CSR form. Each layer is read from the vertices
+ * of the previous one, so the queue is a single array in BFS order
+ * @param sorted        arrays of arrays corresponding to layers
+ * @param g             graph
+ * @return              true if the graph is DAG else false
+ *                      (topological sorting not possible)
+ */
+bool toposort(std::vector<std::vector<int>> & sorted, const CsrGraph & g) {
+    int n = g.vertices();
+    std::vector<int> deg(n, 0);
+    for (int x = 0; x < n; x++) {
+        for (int y : g.neighbors(x)) {
+            deg[y]++;
+        }
+    }
+    std::vector<int> Q;
+    Q.reserve(n);
+    for (int x = 0; x < n; x++) {
+        if (deg[x] == 0) {
+            Q.push_back(x);
+        }
+    }
+    std::size_t layer_begin = 0;
+    while (layer_begin < Q.size()) {
+        std::size_t layer_end = Q.size();
+        for (std::size_t i = layer_begin; i < layer_end; i++) {
+            for (int y : g.neighbors(Q[i])) {
+                if (--deg[y] == 0) {
+                    Q.push_back(y);
+                }
+            }
+        }
+        sorted.emplace_back(Q.begin() + layer_begin, Q.begin() + layer_end);
+        layer_begin = layer_end;
+    }
+    if (Q.empty()) {
+        sorted.emplace_back();
+    }
+    return static_cast<int>(Q.size()) == n;
+}
+
 #endif // ALGORITHMS_TOPOSORT_H
\ No newline at end of file
@@ -6,8 +6,10 @@
  * Space complexity: O(|V|+|E|)
  */
 
+#include <cstddef>
 #include <vector>
 #include <functional>
+#include "csr_graph.hpp"
 
 #ifndef ALGORITHMS_TURBO_H
 #define ALGORITHMS_TURBO_H
@@ -50,4 +52,63 @@ int find_match(std::vector<std::vector<int>>& adj) {
     return n_matched / 2;
 }
 
+/**
+ * Find the maximum match in bipartite graph in CSR form. The augmenting
+ * path is searched with an explicit stack: next[u] is the next arc of u
+ * to try, and when a free vertex is reached, the arc taken last from
+ * every vertex on the stack becomes matched, from the top down like the
+ * recursion above
+ * @param g         graph
+ * @return          size of the maximum match
+ */
+int find_match(const CsrGraph & g) {
+    int n = g.vertices();
+    std::vector<int> M(n, -1);
+    std::vector<std::size_t> next(n);
+    std::vector<int> stack;
+    bool found;
+    do {
+        std::vector<bool> vis(n, false);
+        auto augment = [&](int root) -> bool {
+            vis[root] = true;
+            next[root] = g.begin(root);
+            stack.assign(1, root);
+            while (!stack.empty()) {
+                int u = stack.back();
+                if (next[u] == g.end(u)) {
+                    stack.pop_back();
+                    continue;
+                }
+                int v = g.target_of(next[u]++);
+                if (M[v] == -1) {
+                    for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+                        int x = *it, y = g.target_of(next[x] - 1);
+                        M[x] = y;
+                        M[y] = x;
+                    }
+                    return true;
+                }
+                if (!vis[M[v]]) {
+                    vis[M[v]] = true;
+                    next[M[v]] = g.begin(M[v]);
+                    stack.push_back(M[v]);
+                }
+            }
+            return false;
+        };
+        found = false;
+        for (int u = 0; u < n; u++) {
+            if (M[u] == -1) {
+                found |= augment(u);
+            }
+        }
+    } while (found);
+
+    int n_matched = 0;
+    for (int i = 0; i < n; i++) {
+        if (M[i] != -1) n_matched++;
+    }
+    return n_matched / 2;
+}
+
 #endif // ALGORITHMS_TURBO_H
\ No newline at end of file
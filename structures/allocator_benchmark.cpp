@@ -0,0 +1,77 @@
+#include "unordered_map.hpp"
+#include "double_linked_list.hpp"
+#include "memory_pool.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * Build a map of n keys, erase and insert back half of them,
+ * then clear it, several times over the same map
+ */
+template <class Allocator>
+void bench_map(const std::string & name, int n, int rounds) {
+    using K = std::uint64_t;
+    UnorderedMap<K, K, MultiplyShiftHash<K>, WyHash<K>, Allocator> map;
+    auto start = Clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < n; i++) {
+            map.insert({static_cast<K>(i), static_cast<K>(i)});
+        }
+        for (int i = 0; i < n; i += 2) {
+            map.erase(static_cast<K>(i));
+        }
+        for (int i = 0; i < n; i += 2) {
+            map.insert({static_cast<K>(i), static_cast<K>(i)});
+        }
+        map.clear();
+    }
+    std::cout << "  " << name << ": " << elapsed_ms(start) << " ms" << std::endl;
+}
+
+/**
+ * Push n elements to a list, pop half of them and clear it,
+ * several times over the same list
+ */
+template <class Allocator>
+void bench_list(const std::string & name, int n, int rounds) {
+    DoubleList<std::uint64_t, Allocator> list;
+    auto start = Clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < n; i++) {
+            if (i % 2 == 0) {
+                list.push_back(i);
+            } else {
+                list.push_front(i);
+            }
+        }
+        for (int i = 0; i < n / 2; i++) {
+            list.destroy(list.pop_back());
+        }
+        list.clear();
+    }
+    std::cout << "  " << name << ": " << elapsed_ms(start) << " ms" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::cout << "UnorderedMap, " << rounds << " rounds of " << n << " keys" << std::endl;
+    bench_map<std::allocator<std::pair<std::uint64_t, std::uint64_t>>>("std::allocator", n, rounds);
+    bench_map<ArenaAllocator<std::pair<std::uint64_t, std::uint64_t>>>("ArenaAllocator", n, rounds);
+    bench_map<PoolAllocator<std::pair<std::uint64_t, std::uint64_t>>>("PoolAllocator", n, rounds);
+    std::cout << "DoubleList, " << rounds << " rounds of " << n << " elements" << std::endl;
+    bench_list<std::allocator<std::uint64_t>>("std::allocator", n, rounds);
+    bench_list<ArenaAllocator<std::uint64_t>>("ArenaAllocator", n, rounds);
+    bench_list<PoolAllocator<std::uint64_t>>("PoolAllocator", n, rounds);
+    return 0;
+}
@@ -0,0 +1,394 @@
+/**
+ * An implementation of unordered map template for concurrent use
+ * based on the cuckoo hashing with two tables of 4-way buckets.
+ *
+ * The buckets are guarded by a fixed array of striped locks, each
+ * with a version counter (a sequence lock). Lookups take no lock: they read
+ * both candidate buckets and retry if the version of either stripe changed.
+ * Insertions lock only the two stripes of the key and, when both buckets are
+ * full, search for a cuckoo path with BFS without holding any lock. The path
+ * is then executed from its free end, one move at a time under the two locks
+ * of the buckets involved, so the critical sections stay short.
+ * When no path is found, the tables are doubled under all the locks.
+ *
+ * Keys and values are stored inline in the buckets as lock-free atomics,
+ * so they have to be small trivially copyable types (integers, pointers).
+ * Replaced tables are released only when the map is destroyed, because
+ * a concurrent lookup may still be reading them.
+ */
+
+#ifndef ALGORITHMS_CONCURRENT_UNORDERED_MAP_HPP
+#define ALGORITHMS_CONCURRENT_UNORDERED_MAP_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "hashing.hpp"
+
+template <class Key, class Value, class Hash1 = MultiplyShiftHash<Key>, class Hash2 = WyHash<Key>>
+class ConcurrentUnorderedMap {
+    static_assert(std::atomic<Key>::is_always_lock_free && std::atomic<Value>::is_always_lock_free,
+                  "keys and values have to be lock-free atomic types");
+    static constexpr int WAYS = 4;
+    static constexpr std::size_t STRIPES = 1024;
+    static constexpr int MAX_PATH = 5;
+
+    struct Slot {
+        std::atomic<bool> full;
+        std::atomic<Key> key;
+        std::atomic<Value> value;
+    };
+
+    struct Bucket {
+        Slot slots[WAYS];
+    };
+
+    struct Table {
+        std::size_t capacity;
+        int shift;
+        std::unique_ptr<Bucket[]> tab[2];
+
+        explicit Table(std::size_t _capacity) : capacity(_capacity), shift(64 - std::countr_zero(_capacity)) {
+            tab[0] = std::make_unique<Bucket[]>(capacity);
+            tab[1] = std::make_unique<Bucket[]>(capacity);
+        }
+    };
+
+    struct alignas(64) Stripe {
+        std::atomic<std::uint64_t> version{0};     // odd while locked
+
+        void lock() {
+            std::uint64_t v = version.load(std::memory_order_relaxed);
+            while ((v & 1) || !version.compare_exchange_weak(v, v + 1, std::memory_order_acquire)) {
+                std::this_thread::yield();
+                v = version.load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        void unlock() {
+            version.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    /**
+     * Position of a slot on a cuckoo path
+     */
+    struct Step {
+        int t;
+        std::size_t b;
+        int w;
+        Key key;
+        int parent;
+    };
+
+    Hash1 hash1;
+    Hash2 hash2;
+    std::atomic<Table*> table;
+    std::vector<std::unique_ptr<Table>> tables;     // current one and the replaced ones
+    std::unique_ptr<Stripe[]> stripes;
+    std::atomic<std::size_t> map_size{0};
+
+    std::size_t getHash(int t, const Key & key, const Table* tb) const {
+        return (t == 0 ? hash1(key) : hash2(key)) >> tb->shift;
+    }
+    static Stripe& stripe(Stripe* s, int t, std::size_t b) {
+        return s[(2 * b + t) & (STRIPES - 1)];
+    }
+
+    /**
+     * Lock the stripes of two buckets in a fixed order
+     */
+    void lockPair(Stripe& s1, Stripe& s2) {
+        if (&s1 == &s2) {
+            s1.lock();
+        } else if (&s1 < &s2) {
+            s1.lock(); s2.lock();
+        } else {
+            s2.lock(); s1.lock();
+        }
+    }
+    void unlockPair(Stripe& s1, Stripe& s2) {
+        s1.unlock();
+        if (&s1 != &s2) {
+            s2.unlock();
+        }
+    }
+
+    static int findWay(const Bucket & bucket, const Key & key) {
+        for (int w = 0; w < WAYS; ++w) {
+            if (bucket.slots[w].full.load(std::memory_order_relaxed)
+                && bucket.slots[w].key.load(std::memory_order_relaxed) == key) {
+                return w;
+            }
+        }
+        return -1;
+    }
+    static int freeWay(const Bucket & bucket) {
+        for (int w = 0; w < WAYS; ++w) {
+            if (!bucket.slots[w].full.load(std::memory_order_relaxed)) {
+                return w;
+            }
+        }
+        return -1;
+    }
+    static void put(Slot & slot, const Key & key, const Value & value) {
+        slot.key.store(key, std::memory_order_relaxed);
+        slot.value.store(value, std::memory_order_relaxed);
+        slot.full.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * Search for the shortest sequence of moves that frees a slot in one
+     * of the buckets b1, b2. No locks are held, the result is validated
+     * while executing it.
+     * @return          path from a slot of b1 or b2 to a bucket with a free
+     *                  slot, empty if there is no path of length at most MAX_PATH
+     */
+    std::vector<Step> findPath(const Table* tb, std::size_t b1, std::size_t b2) const {
+        std::vector<Step> queue;
+        std::vector<int> depth;
+        for (int t = 0; t < 2; ++t) {
+            for (int w = 0; w < WAYS; ++w) {
+                queue.push_back({t, t == 0 ? b1 : b2, w, Key(), -1});
+                depth.push_back(1);
+            }
+        }
+        for (std::size_t i = 0; i < queue.size(); ++i) {
+            Step step = queue[i];
+            const Slot & slot = tb->tab[step.t][step.b].slots[step.w];
+            if (!slot.full.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            step.key = slot.key.load(std::memory_order_relaxed);
+            queue[i].key = step.key;
+            int alt = 1 - step.t;
+            std::size_t b = getHash(alt, step.key, tb);
+            int w = freeWay(tb->tab[alt][b]);
+            if (w >= 0) {
+                std::vector<Step> path = {{alt, b, w, Key(), -1}};
+                for (int j = static_cast<int>(i); j >= 0; j = queue[j].parent) {
+                    path.push_back(queue[j]);
+                }
+                return {path.rbegin(), path.rend()};
+            }
+            if (depth[i] < MAX_PATH) {
+                for (int v = 0; v < WAYS; ++v) {
+                    queue.push_back({alt, b, v, Key(), static_cast<int>(i)});
+                    depth.push_back(depth[i] + 1);
+                }
+            }
+        }
+        return {};
+    }
+
+    /**
+     * Execute the path from its free end, moving one key at a time
+     * @return          True if all moves were valid
+     */
+    bool movePath(Table* tb, const std::vector<Step> & path) {
+        for (int i = static_cast<int>(path.size()) - 2; i >= 0; --i) {
+            const Step & from = path[i];
+            const Step & to = path[i + 1];
+            Stripe& s1 = stripe(stripes.get(), from.t, from.b);
+            Stripe& s2 = stripe(stripes.get(), to.t, to.b);
+            lockPair(s1, s2);
+            Slot & src = tb->tab[from.t][from.b].slots[from.w];
+            Bucket & dst = tb->tab[to.t][to.b];
+            int w = freeWay(dst);
+            bool valid = table.load(std::memory_order_relaxed) == tb && w >= 0
+                         && src.full.load(std::memory_order_relaxed)
+                         && src.key.load(std::memory_order_relaxed) == from.key;
+            if (valid) {
+                put(dst.slots[w], from.key, src.value.load(std::memory_order_relaxed));
+                src.full.store(false, std::memory_order_relaxed);
+            }
+            unlockPair(s1, s2);
+            if (!valid) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Put the key in the table during a rebuild, which is done under
+     * all the locks, with a random walk of displacements
+     * @return          True if succeeded
+     */
+    bool rebuildPut(Table* tb, Key key, Value value) {
+        for (int i = 0; i < 500; ++i) {
+            for (int t = 0; t < 2; ++t) {
+                Bucket & bucket = tb->tab[t][getHash(t, key, tb)];
+                int w = freeWay(bucket);
+                if (w >= 0) {
+                    put(bucket.slots[w], key, value);
+                    return true;
+                }
+            }
+            Slot & victim = tb->tab[i & 1][getHash(i & 1, key, tb)].slots[(i / 2) % WAYS];
+            Key k = victim.key.load(std::memory_order_relaxed);
+            Value v = victim.value.load(std::memory_order_relaxed);
+            put(victim, key, value);
+            key = k; value = v;
+        }
+        return false;
+    }
+
+    /**
+     * Double the tables under all the locks unless another thread already did
+     */
+    void grow(Table* old) {
+        for (std::size_t i = 0; i < STRIPES; ++i) {
+            stripes[i].lock();
+        }
+        if (table.load(std::memory_order_relaxed) == old) {
+            std::size_t capacity = old->capacity;
+            bool done = false;
+            while (!done) {
+                capacity *= 2;
+                tables.push_back(std::make_unique<Table>(capacity));
+                done = true;
+                for (int t = 0; t < 2 && done; ++t) {
+                    for (std::size_t b = 0; b < old->capacity && done; ++b) {
+                        for (auto & slot : old->tab[t][b].slots) {
+                            if (slot.full.load(std::memory_order_relaxed)) {
+                                done = done && rebuildPut(tables.back().get(), slot.key.load(std::memory_order_relaxed),
+                                                          slot.value.load(std::memory_order_relaxed));
+                            }
+                        }
+                    }
+                }
+            }
+            table.store(tables.back().get(), std::memory_order_release);
+        }
+        for (std::size_t i = 0; i < STRIPES; ++i) {
+            stripes[i].unlock();
+        }
+    }
+
+public:
+    explicit ConcurrentUnorderedMap(std::size_t capacity = 64, std::uint64_t seed = 0)
+        : hash1(seed), hash2(seed + 1), stripes(std::make_unique<Stripe[]>(STRIPES)) {
+        tables.push_back(std::make_unique<Table>(std::bit_ceil(std::max<std::size_t>(capacity, 2))));
+        table.store(tables.back().get());
+    }
+
+    ConcurrentUnorderedMap(const ConcurrentUnorderedMap &) = delete;
+    ConcurrentUnorderedMap& operator=(const ConcurrentUnorderedMap &) = delete;
+
+    /**
+     * Find the value of the key without taking any lock
+     * @param key
+     * @return          the value or nullopt if key is absent
+     */
+    std::optional<Value> find(const Key & key) const {
+        std::uint64_t h1 = hash1(key), h2 = hash2(key);
+        for (;;) {
+            Table* tb = table.load(std::memory_order_acquire);
+            std::size_t b1 = h1 >> tb->shift, b2 = h2 >> tb->shift;
+            Stripe& s1 = stripe(stripes.get(), 0, b1);
+            Stripe& s2 = stripe(stripes.get(), 1, b2);
+            std::uint64_t v1 = s1.version.load(std::memory_order_acquire);
+            std::uint64_t v2 = s2.version.load(std::memory_order_acquire);
+            if ((v1 | v2) & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::optional<Value> result;
+            for (int t = 0; t < 2 && !result; ++t) {
+                const Bucket & bucket = tb->tab[t][t == 0 ? b1 : b2];
+                int w = findWay(bucket, key);
+                if (w >= 0) {
+                    result = bucket.slots[w].value.load(std::memory_order_relaxed);
+                }
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s1.version.load(std::memory_order_relaxed) == v1 && s2.version.load(std::memory_order_relaxed) == v2
+                && table.load(std::memory_order_relaxed) == tb) {
+                return result;
+            }
+        }
+    }
+
+    /**
+     * Insert the pair or assign the value if the key is present
+     * @return          True if the key was inserted
+     */
+    bool insert(const Key & key, const Value & value) {
+        for (;;) {
+            Table* tb = table.load(std::memory_order_acquire);
+            std::size_t b1 = getHash(0, key, tb), b2 = getHash(1, key, tb);
+            Stripe& s1 = stripe(stripes.get(), 0, b1);
+            Stripe& s2 = stripe(stripes.get(), 1, b2);
+            lockPair(s1, s2);
+            if (table.load(std::memory_order_relaxed) != tb) {
+                unlockPair(s1, s2);
+                continue;
+            }
+            for (Bucket* bucket : {&tb->tab[0][b1], &tb->tab[1][b2]}) {
+                int w = findWay(*bucket, key);
+                if (w >= 0) {
+                    bucket->slots[w].value.store(value, std::memory_order_relaxed);
+                    unlockPair(s1, s2);
+                    return false;
+                }
+            }
+            for (Bucket* bucket : {&tb->tab[0][b1], &tb->tab[1][b2]}) {
+                int w = freeWay(*bucket);
+                if (w >= 0) {
+                    put(bucket->slots[w], key, value);
+                    unlockPair(s1, s2);
+                    map_size.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            unlockPair(s1, s2);
+            std::vector<Step> path = findPath(tb, b1, b2);
+            if (path.empty()) {
+                grow(tb);
+            } else {
+                movePath(tb, path);
+            }
+        }
+    }
+
+    /**
+     * Remove the key from the map
+     * @return          number of removed elements
+     */
+    std::size_t erase(const Key & key) {
+        for (;;) {
+            Table* tb = table.load(std::memory_order_acquire);
+            std::size_t b1 = getHash(0, key, tb), b2 = getHash(1, key, tb);
+            Stripe& s1 = stripe(stripes.get(), 0, b1);
+            Stripe& s2 = stripe(stripes.get(), 1, b2);
+            lockPair(s1, s2);
+            if (table.load(std::memory_order_relaxed) != tb) {
+                unlockPair(s1, s2);
+                continue;
+            }
+            std::size_t erased = 0;
+            for (Bucket* bucket : {&tb->tab[0][b1], &tb->tab[1][b2]}) {
+                int w = findWay(*bucket, key);
+                if (w >= 0 && erased == 0) {
+                    bucket->slots[w].full.store(false, std::memory_order_relaxed);
+                    erased = 1;
+                }
+            }
+            unlockPair(s1, s2);
+            map_size.fetch_sub(erased, std::memory_order_relaxed);
+            return erased;
+        }
+    }
+
+    std::size_t size() const {
+        return map_size.load(std::memory_order_relaxed);
+    }
+};
+
+#endif //ALGORITHMS_CONCURRENT_UNORDERED_MAP_HPP
@@ -0,0 +1,176 @@
+/**
+ * Implementation of a d-ary heap with custom comparator, with the same
+ * interface as Heap. Every node has D children (D is fixed at compile time,
+ * typically 4 or 8) stored next to each other, and the array is placed so
+ * that the children of a node start at a cache line boundary. For small
+ * types, the children fit in one cache line, so a level of sift-down costs
+ * one cache miss, and there are log_D(n) levels instead of log_2(n).
+ *
+ * Pop uses the bottom-up sift-down: the hole left by the root is moved
+ * down along the path of the best children to a leaf, and then the last
+ * element is moved up from there. Elements are moved into the hole instead
+ * of being swapped, and the element that replaces the root, which usually
+ * belongs near the leaves, is compared only on the way up.
+ */
+
+#ifndef ALGORITHMS_DARY_HEAP_HPP
+#define ALGORITHMS_DARY_HEAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "memory_pool.hpp"
+
+template<typename T, typename Compare = std::less<T>, int D = 4>
+class DaryHeap {
+    static_assert(D >= 2, "heap nodes need at least two children");
+    static constexpr std::size_t CACHE_LINE = 64;
+    // H[i + OFFSET] is the i-th element, so the first child D*i + 1
+    // of every node is at a multiple of D in the aligned array
+    static constexpr std::size_t OFFSET = D - 1;
+    static constexpr std::size_t PER_LINE = CACHE_LINE / sizeof(T) > 0 ? CACHE_LINE / sizeof(T) : 1;
+
+    std::vector<T, AlignedAllocator<T, CACHE_LINE>> H;
+    std::size_t _size = 0;
+    Compare compare;
+
+    T & at(std::size_t i) {
+        return H[i + OFFSET];
+    }
+
+    /**
+     * Index of the best child among the children of i, which must exist.
+     * The children are compared in a tournament whose choices compile
+     * to conditional moves, as random keys would mispredict branches.
+     */
+    std::size_t bestChild(std::size_t i) {
+        std::size_t first = D * i + 1;
+        if (first + D <= _size) {
+            std::size_t best[D];
+            for (int c = 0; c < D; ++c) {
+                best[c] = first + c;
+            }
+            for (int width = D; width > 1; width = (width + 1) / 2) {
+                for (int c = 0; c + 1 < width; c += 2) {
+                    std::size_t a = best[c], b = best[c + 1];
+                    best[c / 2] = compare(at(a), at(b)) ? b : a;
+                }
+                if (width % 2 == 1) {
+                    best[width / 2] = best[width - 1];
+                }
+            }
+            return best[0];
+        }
+        std::size_t best = first;
+        for (std::size_t c = first + 1; c < _size; ++c) {
+            best = compare(at(best), at(c)) ? c : best;
+        }
+        return best;
+    }
+
+    /**
+     * Move value up from the hole at i, shifting the parents down
+     */
+    void siftUp(std::size_t i, T && value) {
+        while (i > 0) {
+            std::size_t parent = (i - 1) / D;
+            if (!compare(at(parent), value)) break;
+            at(i) = std::move(at(parent));
+            i = parent;
+        }
+        at(i) = std::move(value);
+    }
+
+    void grow() {
+        if (_size + OFFSET == H.size()) {
+            H.resize(H.size() * 2);
+        }
+    }
+
+public:
+    DaryHeap() : H(OFFSET + 8), compare(Compare()) { }
+    explicit DaryHeap(int capacity, Compare comp = Compare())
+        : H(OFFSET + (capacity > 0 ? capacity : 1)), compare(comp) { }
+
+    int size() const {
+        return static_cast<int>(_size);
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * Bottom-up sift-down of the element at i
+     * @param i
+     */
+    void makeHeap(std::size_t i) {
+        if (D * i + 1 >= _size) return;
+        T value = std::move(at(i));
+        std::size_t hole = i;
+        while (D * hole + 1 < _size) {
+            // the grandchildren are read on the next level whichever child wins
+            std::size_t grandchild = D * (D * hole + 1) + 1;
+            std::size_t end = std::min(grandchild + D * D, _size);
+            for (std::size_t g = grandchild; g < end; g += PER_LINE) {
+                __builtin_prefetch(&at(g));
+            }
+            if (grandchild < end) {
+                __builtin_prefetch(&at(end - 1));
+            }
+            std::size_t child = bestChild(hole);
+            at(hole) = std::move(at(child));
+            hole = child;
+        }
+        while (hole > i) {
+            std::size_t parent = (hole - 1) / D;
+            if (!compare(at(parent), value)) break;
+            at(hole) = std::move(at(parent));
+            hole = parent;
+        }
+        at(hole) = std::move(value);
+    }
+
+    T pop() {
+        if (_size == 0) {
+            throw std::out_of_range("Heap is empty");
+        }
+        T root = std::move(at(0));
+        if (--_size > 0) {
+            at(0) = std::move(at(_size));
+            makeHeap(0);
+        }
+        return root;
+    }
+
+    const T & top() const {
+        if (_size == 0) {
+            throw std::out_of_range("Heap is empty");
+        }
+        return H[OFFSET];
+    }
+
+    void insert(const T & key) {
+        grow();
+        siftUp(_size++, T(key));
+    }
+
+    void insert(T && key) {
+        grow();
+        siftUp(_size++, std::move(key));
+    }
+
+    /**
+     * Construct the element from args and add it to the heap
+     * @param args      arguments of the T constructor
+     */
+    template <class... Args>
+    void emplace(Args&&... args) {
+        insert(T(std::forward<Args>(args)...));
+    }
+};
+
+#endif //ALGORITHMS_DARY_HEAP_HPP
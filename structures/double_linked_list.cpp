@@ -41,13 +41,13 @@ int main() {
         std::cout << x << " ";
     }
     std::cout << std::endl;
-    trainA.pop_front();
+    trainA.destroy(trainA.pop_front());
     std::cout << "trainA: remove first" << std::endl;
     for (auto x : trainA) {
         std::cout << x << " ";
     }
     std::cout << std::endl;
-    trainA.pop_back();
+    trainA.destroy(trainA.pop_back());
     std::cout << "trainA: remove last" << std::endl;
     for (auto x : trainA) {
         std::cout << x << " ";
@@ -1,13 +1,18 @@
 /**
- * Implementation of double linked list template with reverse
- * and merge operations. All operations (except clear) are performed
- * in constant time.
+ * Implementation of double linked list template with reverse, merge,
+ * splice and split operations. All operations (except clear) are
+ * performed in constant time. Nodes are allocated with Allocator rebound
+ * to Node<T>, e.g. PoolAllocator from memory_pool.hpp.
  */
 
 #ifndef ALGORITHMS_DOUBLE_LINKED_LIST_HPP
 #define ALGORITHMS_DOUBLE_LINKED_LIST_HPP
 
 #include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "memory_pool.hpp"
 
 template <class T>
 class Node {
@@ -15,7 +20,10 @@ public:
     T name;
     Node* next[2];
     Node( ) = default;
-    Node(const T & _name) { name = _name; }
+    Node(const T & _name) : name(_name) { }
+    Node(T && _name) : name(std::move(_name)) { }
+    template <class... Args>
+    explicit Node(std::in_place_t, Args&&... args) : name(std::forward<Args>(args)...) { }
 
     friend std::ostream &operator<<(std::ostream &os, const Node & node) {
         os << node.name;
@@ -23,18 +31,37 @@ public:
     }
 };
 
-template <class T>
+template <class T, class Allocator = std::allocator<T>>
 class DoubleList {
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node<T>>;
+    using Traits = std::allocator_traits<NodeAllocator>;
+    NodeAllocator node_alloc;
+
 public:
     Node<T>* head;
     Node<T>* tail;
-    DoubleList () {
-        head = new Node<T>();
-        tail = new Node<T>();
-        head->next[0] = tail;
-        head->next[1] = tail;
-        tail->next[0] = head;
-        tail->next[1] = head;
+    explicit DoubleList (const Allocator & alloc = Allocator()) : node_alloc(alloc) {
+        createEnds();
+    }
+    DoubleList (const DoubleList &) = delete;
+    DoubleList& operator=(const DoubleList &) = delete;
+    /**
+     * Take the nodes of L without allocating. L is left empty with a copy
+     * of the allocator and allocates its head and tail again on the next
+     * insertion.
+     * @param L
+     */
+    DoubleList (DoubleList && L) noexcept : node_alloc(L.node_alloc), head(L.head), tail(L.tail) {
+        L.head = L.tail = nullptr;
+    }
+    DoubleList& operator=(DoubleList && L) noexcept {
+        swap(L);
+        return *this;
+    }
+    void swap(DoubleList & L) noexcept {
+        std::swap(node_alloc, L.node_alloc);
+        std::swap(head, L.head);
+        std::swap(tail, L.tail);
     }
     ~DoubleList () {
         clear();
@@ -43,7 +70,48 @@ public:
     }
 
     bool empty() {
-        return (head->next[0] == tail && head->next[1] == tail);
+        return head == nullptr || (head->next[0] == tail && head->next[1] == tail);
+    }
+
+    /**
+     * Allocate the head and tail of an empty list
+     */
+    void createEnds() {
+        auto new_head = std::make_unique<Node<T>>();
+        tail = new Node<T>();
+        head = new_head.release();
+        head->next[0] = tail;
+        head->next[1] = tail;
+        tail->next[0] = head;
+        tail->next[1] = head;
+    }
+
+    /**
+     * Allocate a node that can be added to the list, and the head and tail
+     * if the list was moved from
+     * @param args      arguments of the T constructor
+     * @return          pointer to the new node
+     */
+    template <class... Args>
+    Node<T>* create(Args&&... args) {
+        if (head == nullptr) createEnds();
+        Node<T>* node = Traits::allocate(node_alloc, 1);
+        try {
+            Traits::construct(node_alloc, node, std::in_place, std::forward<Args>(args)...);
+        } catch (...) {
+            Traits::deallocate(node_alloc, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    /**
+     * Free a node removed from the list by pop_front or pop_back
+     * @param node
+     */
+    void destroy(Node<T>* node) {
+        Traits::destroy(node_alloc, node);
+        Traits::deallocate(node_alloc, node, 1);
     }
 
     /**
@@ -51,15 +119,31 @@ public:
      * @param name
      */
     void push_front(const T & name) {
-        auto * node = new Node<T>(name);
+        auto * node = create(name);
+        push_front(node);
+    }
+
+    void push_front(T && name) {
+        auto * node = create(std::move(name));
         push_front(node);
     }
 
     /**
-     * Add the node to the beginning of the list
+     * Add node with element constructed from args to the beginning of the list
+     * @param args      arguments of the T constructor
+     */
+    template <class... Args>
+    void emplace_front(Args&&... args) {
+        push_front(create(std::forward<Args>(args)...));
+    }
+
+    /**
+     * Add the node to the beginning of the list.
+     * The node has to be allocated by create()
      * @param n
      */
     void push_front(Node<T>* node) {
+        if (head == nullptr) createEnds();
         bool dir_head = (head->next[0] == tail);
         bool dir_sec = (head->next[dir_head]->next[1] == head);
         node->next[dir_head] = head->next[dir_head];
@@ -73,15 +157,31 @@ public:
      * @param name
      */
     void push_back(const T & name) {
-        auto * node = new Node<T>(name);
+        auto * node = create(name);
         push_back(node);
     }
 
+    void push_back(T && name) {
+        auto * node = create(std::move(name));
+        push_back(node);
+    }
+
+    /**
+     * Add node with element constructed from args to the end of the list
+     * @param args      arguments of the T constructor
+     */
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        push_back(create(std::forward<Args>(args)...));
+    }
+
     /**
-     * Add node to the end of the list
+     * Add node to the end of the list.
+     * The node has to be allocated by create()
      * @param node
      */
     void push_back(Node<T>* node) {
+        if (head == nullptr) createEnds();
         bool dir_tail = (tail->next[0] == head);
         bool dir_last = (tail->next[dir_tail]->next[1] == tail);
         node->next[dir_tail] = tail->next[dir_tail];
@@ -93,6 +193,7 @@ public:
     /**
      * Remove the first element from the list.
      * If list is empty, return nullptr;
+     * The node should be freed by destroy()
      * @return      pointer to the removed node
      */
     Node<T> * pop_front() {
@@ -111,6 +212,7 @@ public:
     /**
      * Remove the last element from the list.
      * If list is empty, return nullptr;
+     * The node should be freed by destroy()
      * @return      pointer to the removed node
      */
     Node<T> * pop_back() {
@@ -145,11 +247,21 @@ public:
 
     /**
      * Add all elements of list L to the end of this list
-     * After the operation, L becomes empty
+     * After the operation, L becomes empty.
+     * If the allocators of the lists differ, the nodes cannot be relinked
+     * and the elements are moved one by one instead
      * @param L
      */
-    void merge(DoubleList<T>& L) {
+    void merge(DoubleList& L) {
         if (L.empty()) return;
+        if (!(node_alloc == L.node_alloc)) {
+            for (Node<T>* node = L.pop_front(); node != nullptr; node = L.pop_front()) {
+                push_back(std::move(node->name));
+                L.destroy(node);
+            }
+            return;
+        }
+        if (head == nullptr) createEnds();
         bool dir_tail = (tail->next[0] == head);
         bool dir_last = (tail->next[dir_tail]->next[1] == tail);
         bool dir_head_L = (L.head->next[0] == L.tail);
@@ -169,20 +281,31 @@ public:
     }
 
     /**
-     * Remove elements from the list
+     * Remove elements from the list. If the list is the only user of its
+     * allocator's resource, the slabs are released at once, and nodes
+     * of trivially destructible elements are not even visited
      */
     void clear() {
         if (empty()) return;
-        bool dir_head = (head->next[0] == tail);
-        Node<T>* temp = head->next[dir_head];
-        bool dir_this, dir_next = (temp->next[0] == head);
-        while (temp != tail) {
-            dir_this = dir_next;
-            dir_next = (temp->next[dir_this]->next[0] == temp);
-            head->next[dir_head] = temp->next[dir_this];
-            head->next[dir_head]->next[1-dir_next] = head;
-            delete temp;
-            temp = head->next[dir_head];
+        bool bulk = memory::ownsResource(node_alloc);
+        if (!bulk || !std::is_trivially_destructible_v<T>) {
+            bool dir_head = (head->next[0] == tail);
+            Node<T>* temp = head->next[dir_head];
+            bool dir_this, dir_next = (temp->next[0] == head);
+            while (temp != tail) {
+                dir_this = dir_next;
+                dir_next = (temp->next[dir_this]->next[0] == temp);
+                head->next[dir_head] = temp->next[dir_this];
+                head->next[dir_head]->next[1-dir_next] = head;
+                Traits::destroy(node_alloc, temp);
+                if (!bulk) {
+                    Traits::deallocate(node_alloc, temp, 1);
+                }
+                temp = head->next[dir_head];
+            }
+        }
+        if (bulk) {
+            memory::release(node_alloc);
         }
         head->next[0] = tail;
         head->next[1] = tail;
@@ -214,14 +337,63 @@ public:
     };
 
     Iterator begin() const {
+        if (head == nullptr) return Iterator(nullptr, nullptr);
         bool dir = (head->next[0] == tail);
         return Iterator(head->next[dir], head);
     }
 
     Iterator end() const {
+        if (tail == nullptr) return Iterator(nullptr, nullptr);
         bool dir = (tail->next[0] == head);
         return Iterator(tail, tail->next[dir]);
     }
+
+    /**
+     * Cut the list before the element of it. The elements from it to the
+     * end are moved to the returned list by relinking the two nodes at
+     * the cut, and the list keeps those before it.
+     * @param it    iterator of this list
+     * @return      list of the elements from it to the end
+     */
+    DoubleList split_at(const Iterator & it) {
+        DoubleList rest(node_alloc);
+        Node<T>* first = it.current;
+        Node<T>* prev = it.prev;
+        if (first == tail) return rest;
+        if (prev == head) {
+            std::swap(head, rest.head);
+            std::swap(tail, rest.tail);
+            return rest;
+        }
+        bool dir_tail = (tail->next[0] == head);
+        Node<T>* last = tail->next[dir_tail];
+        bool dir_last = (last->next[1] == tail);
+        bool dir_prev = (prev->next[1] == first);
+        bool dir_first = (first->next[1] == prev);
+
+        first->next[dir_first] = rest.head;
+        rest.head->next[1] = first;
+        last->next[dir_last] = rest.tail;
+        rest.tail->next[0] = last;
+        prev->next[dir_prev] = tail;
+        tail->next[dir_tail] = prev;
+        return rest;
+    }
+
+    /**
+     * Insert all elements of list L before the element of pos, which may
+     * be end(). After the operation, L becomes empty and the iterators of
+     * both lists are invalidated. Like merge, it takes O(1) if the
+     * allocators of the lists are equal.
+     * @param pos   iterator of this list
+     * @param L
+     */
+    void splice(const Iterator & pos, DoubleList& L) {
+        if (L.empty()) return;
+        DoubleList rest = split_at(pos);
+        merge(L);
+        merge(rest);
+    }
 };
 
 #endif //ALGORITHMS_DOUBLE_LINKED_LIST_HPP
@@ -0,0 +1,124 @@
+#include "double_linked_list.hpp"
+#include "memory_pool.hpp"
+#include "rope.hpp"
+#include "unrolled_double_list.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+template <class List>
+std::uint64_t sum(const List & list) {
+    std::uint64_t total = 0;
+    for (std::uint32_t x : list) {
+        total += x;
+    }
+    return total;
+}
+
+/**
+ * Push n elements to the back, iterate over them, reverse the list and
+ * iterate again. With lists > 1, the elements are pushed round-robin
+ * into that many lists, which are then merged into the first one, so
+ * consecutive elements are far apart in memory for a node per element.
+ */
+template <class List>
+void bench(const std::string & name, std::size_t n, std::size_t lists) {
+    std::vector<List> parts(lists);
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < n; i++) {
+        parts[i % lists].push_back(static_cast<std::uint32_t>(i));
+    }
+    for (std::size_t k = 1; k < lists; k++) {
+        parts[0].merge(parts[k]);
+    }
+    double push_ms = elapsed_ms(start);
+    List & list = parts[0];
+
+    start = Clock::now();
+    std::uint64_t checksum = sum(list);
+    double iterate_ms = elapsed_ms(start);
+
+    start = Clock::now();
+    list.reverse();
+    checksum += sum(list);
+    double reversed_ms = elapsed_ms(start);
+
+    start = Clock::now();
+    list.clear();
+    double clear_ms = elapsed_ms(start);
+    std::cout << "  " << name << ": push_back " << push_ms << " ms, iterate " << iterate_ms
+              << " ms, reverse + iterate " << reversed_ms << " ms, clear " << clear_ms << " ms (checksum "
+              << checksum << ")" << std::endl;
+}
+
+/**
+ * Reverse `operations` random windows of n elements in place in a vector,
+ * which takes time proportional to the window, and in a Rope
+ */
+void bench_reverse_windows(std::size_t n, int operations) {
+    std::vector<std::uint32_t> values(n);
+    for (std::size_t i = 0; i < n; i++) {
+        values[i] = static_cast<std::uint32_t>(i);
+    }
+    std::mt19937_64 gen(2024);
+    std::vector<std::pair<std::size_t, std::size_t>> windows(operations);
+    for (auto & [l, r] : windows) {
+        l = gen() % (n + 1);
+        r = gen() % (n + 1);
+        if (l > r) std::swap(l, r);
+    }
+
+    auto start = Clock::now();
+    Rope<std::uint32_t> rope(values);
+    double build_ms = elapsed_ms(start);
+
+    start = Clock::now();
+    for (auto [l, r] : windows) {
+        std::reverse(values.begin() + l, values.begin() + r);
+    }
+    double vector_ms = elapsed_ms(start);
+
+    start = Clock::now();
+    for (auto [l, r] : windows) {
+        rope.reverse(l, r);
+    }
+    double rope_ms = elapsed_ms(start);
+
+    start = Clock::now();
+    bool same = rope.to_vector() == values;
+    double read_ms = elapsed_ms(start);
+    std::cout << "  " << operations << " windows of " << n << " elements: vector " << vector_ms * 1e3 / operations
+              << " us, Rope " << rope_ms * 1e3 / operations << " us per reverse (build " << build_ms
+              << " ms, read back " << read_ms << " ms, " << (same ? "same" : "different") << " result)" << std::endl;
+}
+
+template <std::size_t Capacity>
+using Unrolled = UnrolledDoubleList<std::uint32_t, std::allocator<std::uint32_t>, Capacity>;
+
+int main(int argc, char* argv[]) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    for (std::size_t lists : {1, 16}) {
+        std::cout << n << " elements" << (lists > 1 ? ", interleaved from " + std::to_string(lists) + " lists" : "")
+                  << std::endl;
+        bench<DoubleList<std::uint32_t>>("DoubleList", n, lists);
+        bench<DoubleList<std::uint32_t, PoolAllocator<std::uint32_t>>>("DoubleList + PoolAllocator", n, lists);
+        bench<Unrolled<16>>("UnrolledDoubleList, 16 per block", n, lists);
+        bench<UnrolledDoubleList<std::uint32_t>>("UnrolledDoubleList, 128 per block", n, lists);
+    }
+    std::cout << "Reverse of random windows" << std::endl;
+    bench_reverse_windows(n / 10, 10000);
+    bench_reverse_windows(n, 10000);
+    return 0;
+}
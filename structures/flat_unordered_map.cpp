@@ -0,0 +1,33 @@
+#include <iostream>
+#include <string>
+#include "flat_unordered_map.hpp"
+
+int main() {
+    FlatUnorderedMap<int, std::string> map;
+
+    // Insert some pairs
+    map.insert({1, "one"});
+    map.insert({2, "two"});
+    map.insert({3, "three"});
+    map[4] = "four";
+    map[5] = "five";
+    // Modify an element
+    map[2] = "TWO";
+
+    // Elements are visited in the order of insertion
+    for (const auto & x : map) {
+        std::cout << x.first << ": " << x.second << std::endl;
+    }
+
+    // Erase some elements
+    map.erase(3);
+    auto it = map.find(4);
+    if (it != map.end()) {
+        map.erase(it);
+    }
+    for (const auto & x : map) {
+        std::cout << x.first << ": " << x.second << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,619 @@
+/**
+ * An implementation of unordered map template using the cuckoo hashing
+ * with flat storage. The key-value pairs are kept inline in a dense array
+ * in the order of insertion and the two hash tables store only indices
+ * into it together with a tag of the key's hash, so a lookup probes at most
+ * two table buckets and only touches the pairs whose tag matched.
+ * Insertions append to the dense array and never allocate a separate node.
+ * Erasures only mark the pair dead; once the dead pairs outnumber the live
+ * ones the array is compacted, which invalidates all iterators except the
+ * one returned by erase.
+ * The amortised cost of insertion and deletion operations is O(1).
+ *
+ * Each position of a table is a bucket of Ways slots (at most 8) whose
+ * one-byte tags are compared all at once within a 64-bit word. A bucket
+ * spans at most 64 bytes, so with Ways = 4 the tables can be filled above
+ * 90% at the same number of cache misses per lookup as with Ways = 1,
+ * which stays below 50%.
+ *
+ * The tables use two independent hashers Hash1 and Hash2 (see hashing.hpp)
+ * and have a power of two number of buckets, indexed by the top bits of the
+ * hashes. A map constructed with a seed draws new hash functions instead
+ * of growing when a rebuild of the tables fails, so a sequence of keys
+ * chosen without knowing the seed cannot force repeated rehashes.
+ *
+ * In the incremental mode (see set_incremental) a growing map keeps the old
+ * tables next to the new ones and every insertion and lookup moves a bounded
+ * number of entries, so no single operation rebuilds the whole tables.
+ */
+
+#ifndef ALGORITHMS_FLAT_UNORDERED_MAP_HPP
+#define ALGORITHMS_FLAT_UNORDERED_MAP_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "hashing.hpp"
+
+template <class Key, class Value, int Ways = 1,
+          class Hash1 = MultiplyShiftHash<Key>, class Hash2 = WyHash<Key>>
+class FlatUnorderedMap {
+    static_assert(1 <= Ways && Ways <= 8, "bucket must fit tags in a 64-bit word");
+    static constexpr std::uint32_t EMPTY = UINT32_MAX;
+    static constexpr std::uint64_t LOW_BITS = 0x0101010101010101ull;
+    static constexpr std::uint64_t HIGH_BITS = 0x8080808080808080ull;
+    static constexpr std::uint64_t WAYS_MASK = Ways == 8 ? ~0ull : (1ull << 8*Ways) - 1;
+    // buckets in each table of an empty map, a power of two for any Ways
+    static constexpr std::size_t INITIAL_CAPACITY = std::bit_ceil(128u / Ways);
+
+    struct alignas(std::bit_ceil(5u * Ways)) Bucket {
+        std::uint8_t tags[Ways] = {};     // 0 marks an empty slot
+        std::uint32_t index[Ways] = {};
+
+        /**
+         * Compare the tag with all tags of the bucket at once
+         * @param tag
+         * @return      word with the highest bit set in each byte
+         *              that may hold the tag
+         */
+        std::uint64_t match(std::uint8_t tag) const {
+            std::uint64_t word = 0;
+            std::memcpy(&word, tags, Ways);
+            std::uint64_t x = word ^ (LOW_BITS * tag);
+            return (x - LOW_BITS) & ~x & HIGH_BITS & WAYS_MASK;
+        }
+    };
+
+    struct Hashes {
+        std::uint64_t h1, h2;
+    };
+
+    std::size_t map_size = 0, capacity = INITIAL_CAPACITY;
+    int shift = 64 - std::countr_zero(capacity);
+    std::size_t kicks = 0, rehash_count = 0;
+    std::uint64_t seed = 0;
+    bool seeded = false;
+    Hash1 hash1;
+    Hash2 hash2;
+    std::vector<std::pair<Key, Value>> entries;
+    std::vector<Hashes> hashes;
+    std::vector<std::uint8_t> alive;
+    std::vector<Bucket> tab1, tab2;
+    std::vector<Bucket> old1, old2;   // tables being migrated in the incremental mode
+    int old_shift = 0;
+    std::size_t migrate_next = 0, migrate_end = 0, migrate_step = 0;
+
+    Hashes getHashes(const Key & key) const {
+        return {hash1(key), hash2(key)};
+    }
+    static std::uint8_t getTag(const Hashes & hash) {
+        auto tag = static_cast<std::uint8_t>((hash.h1 ^ hash.h2) >> 56);
+        return tag == 0 ? 1 : tag;
+    }
+    std::size_t getHash1(const Hashes & hash) const {
+        return hash.h1 >> shift;
+    }
+    std::size_t getHash2(const Hashes & hash) const {
+        return hash.h2 >> shift;
+    }
+
+    /**
+     * Find the slot of the bucket holding the entry with the given key
+     * @param bucket
+     * @param key
+     * @param tag       tag of the key's hash
+     * @return          way of the slot or -1 if key is absent
+     */
+    int findWay(const Bucket & bucket, const Key & key, std::uint8_t tag) const {
+        for (std::uint64_t found = bucket.match(tag); found; found &= found - 1) {
+            int w = std::countr_zero(found) / 8;
+            if (bucket.tags[w] == tag && entries[bucket.index[w]].first == key) {
+                return w;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Find the table slot holding the entry with the given key
+     * @param key
+     * @param hash      hash of the key
+     * @param bucket    set to the bucket holding the entry
+     * @return          way of the slot in bucket or -1 if key is absent
+     */
+    int findSlot(const Key & key, const Hashes & hash, Bucket*& bucket) {
+        std::uint8_t tag = getTag(hash);
+        bucket = &tab1[getHash1(hash)];
+        int w = findWay(*bucket, key, tag);
+        if (w < 0) {
+            bucket = &tab2[getHash2(hash)];
+            w = findWay(*bucket, key, tag);
+        }
+        if (w < 0 && !old1.empty()) {
+            bucket = &old1[hash.h1 >> old_shift];
+            w = findWay(*bucket, key, tag);
+            if (w < 0) {
+                bucket = &old2[hash.h2 >> old_shift];
+                w = findWay(*bucket, key, tag);
+            }
+            if (w >= 0 && !alive[bucket->index[w]]) {
+                w = -1;
+            }
+        }
+        return w;
+    }
+
+    /**
+     * Check if the entry index is already placed in the current tables
+     */
+    bool placed(std::uint32_t index) const {
+        std::uint8_t tag = getTag(hashes[index]);
+        for (const Bucket* bucket : {&tab1[getHash1(hashes[index])], &tab2[getHash2(hashes[index])]}) {
+            for (int w = 0; w < Ways; ++w) {
+                if (bucket->tags[w] == tag && bucket->index[w] == index) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Put the entry index in a free slot of the bucket
+     * @return          True if the bucket had a free slot
+     */
+    bool tryPut(Bucket & bucket, std::uint32_t index) {
+        for (std::uint64_t found = bucket.match(0); found; found &= found - 1) {
+            int w = std::countr_zero(found) / 8;
+            if (bucket.tags[w] == 0) {
+                bucket.tags[w] = getTag(hashes[index]);
+                bucket.index[w] = index;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Replace the entry index in a chosen slot of the full bucket
+     * @return          index of the displaced entry
+     */
+    std::uint32_t kick(Bucket & bucket, std::uint32_t index) {
+        int w = static_cast<int>(kicks++ % Ways);
+        std::swap(bucket.index[w], index);
+        bucket.tags[w] = getTag(hashes[bucket.index[w]]);
+        return index;
+    }
+
+    /**
+     * Place the entry index in one of the tables, displacing other entries
+     * @param index     index of the entry in the dense array
+     * @return          EMPTY if succeeded, otherwise the index of the entry
+     *                  left without a slot
+     */
+    std::uint32_t place(std::uint32_t index) {
+        if (tryPut(tab1[getHash1(hashes[index])], index) || tryPut(tab2[getHash2(hashes[index])], index)) {
+            return EMPTY;
+        }
+        for (int i = 0; i < 100; ++i) {
+            index = kick(tab1[getHash1(hashes[index])], index);
+            if (tryPut(tab2[getHash2(hashes[index])], index)) {
+                return EMPTY;
+            }
+            index = kick(tab2[getHash2(hashes[index])], index);
+            if (tryPut(tab1[getHash1(hashes[index])], index)) {
+                return EMPTY;
+            }
+        }
+        return index;
+    }
+
+    /**
+     * Drop erased entries from the dense array preserving the insertion order
+     */
+    void compact() {
+        std::size_t j = 0;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (alive[i]) {
+                if (i != j) {
+                    entries[j] = std::move(entries[i]);
+                    hashes[j] = hashes[i];
+                }
+                alive[j++] = 1;
+            }
+        }
+        entries.erase(entries.begin() + j, entries.end());
+        hashes.resize(j);
+        alive.resize(j);
+    }
+
+    /**
+     * Mark the entry of the key as erased, leaving it in the dense array
+     * @return      false if the key is not in the map
+     */
+    bool remove(const Key & key) {
+        Bucket* bucket;
+        int w = findSlot(key, getHashes(key), bucket);
+        if (w < 0) {
+            return false;
+        }
+        alive[bucket->index[w]] = 0;
+        bucket->tags[w] = 0;
+        --map_size;
+        return true;
+    }
+
+    /**
+     * Whether the erased entries outnumber both the live entries and the
+     * buckets, so a rebuild dropping them is paid for by the erasures
+     */
+    bool sparse() const {
+        std::size_t dead = entries.size() - map_size;
+        return dead > map_size && dead >= capacity;
+    }
+
+    /**
+     * Draw new hash functions and recompute the hashes of all entries
+     */
+    void reseed() {
+        seed = hashing::splitmix(seed);
+        hash1 = Hash1(seed);
+        hash2 = Hash2(seed + 1);
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            hashes[i] = getHashes(entries[i].first);
+        }
+    }
+
+    /**
+     * Rebuild the tables with the given capacity. If the entries do not fit,
+     * the capacity is doubled or, for a seeded map, new hash functions
+     * are drawn.
+     * @param new_capacity      power of two number of buckets in each table
+     */
+    void rehash(std::size_t new_capacity) {
+        std::vector<Bucket>().swap(old1);
+        std::vector<Bucket>().swap(old2);
+        migrate_next = migrate_end = 0;
+        if (map_size < entries.size()) {
+            compact();
+        }
+        ++rehash_count;
+        capacity = new_capacity / 2;
+        shift = 65 - std::countr_zero(new_capacity);
+        bool done = false, grow = true;
+        while (!done) {
+            if (grow) {
+                capacity *= 2;
+                --shift;
+            } else {
+                reseed();
+            }
+            tab1.assign(capacity, Bucket());
+            tab2.assign(capacity, Bucket());
+            done = true;
+            for (std::uint32_t i = 0; i < entries.size() && done; ++i) {
+                done = place(i) == EMPTY;
+            }
+            grow = !seeded;
+        }
+    }
+
+    /**
+     * Grow the tables after the entry index was left without a slot
+     */
+    void grow(std::uint32_t index) {
+        if (migrate_step == 0 || !old1.empty()) {
+            rehash(2 * capacity);
+            return;
+        }
+        ++rehash_count;
+        old1.swap(tab1);
+        old2.swap(tab2);
+        old_shift = shift;
+        capacity *= 2;
+        --shift;
+        tab1.assign(capacity, Bucket());
+        tab2.assign(capacity, Bucket());
+        migrate_next = 0;
+        migrate_end = entries.size();
+        if (place(index) != EMPTY) {
+            rehash(capacity);
+        }
+    }
+
+    /**
+     * Move at most steps entries from the old tables to the current ones
+     * and release the old tables when all entries are moved
+     */
+    void migrate(std::size_t steps) {
+        if (old1.empty()) return;
+        for (; steps > 0 && migrate_next < migrate_end; --steps, ++migrate_next) {
+            auto i = static_cast<std::uint32_t>(migrate_next);
+            if (alive[i] && !placed(i) && place(i) != EMPTY) {
+                rehash(capacity);
+                return;
+            }
+        }
+        if (migrate_next == migrate_end) {
+            std::vector<Bucket>().swap(old1);
+            std::vector<Bucket>().swap(old2);
+        }
+    }
+
+public:
+    template <bool Const>
+    class BasicIterator;
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    FlatUnorderedMap() : hash1(0), hash2(1), tab1(capacity), tab2(capacity) { }
+
+    /**
+     * Construct the map with hash functions drawn from the seed
+     * @param _seed     e.g. obtained from std::random_device
+     */
+    explicit FlatUnorderedMap(std::uint64_t _seed)
+        : seed(_seed), seeded(true), hash1(_seed), hash2(_seed + 1), tab1(capacity), tab2(capacity) { }
+
+    /**
+     * Switch the incremental resizing on or off. When on, a rehash does not
+     * rebuild the tables at once: every following insertion and lookup
+     * moves a bounded number of entries to the grown tables.
+     * @param entries_per_operation     number of entries moved per operation,
+     *                                  0 switches the mode off
+     */
+    void set_incremental(std::size_t entries_per_operation) {
+        migrate_step = entries_per_operation;
+        if (migrate_step == 0) {
+            migrate(SIZE_MAX);
+        }
+    }
+
+    /**
+     * Prepare the map for n entries so that inserting them
+     * neither reallocates the dense array nor rehashes the tables
+     */
+    void reserve(std::size_t n) {
+        entries.reserve(n);
+        hashes.reserve(n);
+        alive.reserve(n);
+        double max_load = Ways == 1 ? 0.4 : 0.85;
+        std::size_t new_capacity = capacity;
+        while (static_cast<double>(2 * new_capacity * Ways) * max_load < static_cast<double>(n)) {
+            new_capacity *= 2;
+        }
+        if (new_capacity != capacity) {
+            rehash(new_capacity);
+        }
+    }
+
+    std::pair<Iterator, bool> insert(const std::pair<Key, Value> & p) {
+        migrate(migrate_step);
+        Hashes hash = getHashes(p.first);
+        Bucket* bucket;
+        int w = findSlot(p.first, hash, bucket);
+        if (w >= 0) {
+            entries[bucket->index[w]].second = p.second;
+            return std::pair<Iterator, bool>(Iterator(this, bucket->index[w]), false);
+        }
+        if (entries.size() >= EMPTY) {
+            throw std::length_error("Map is too large");
+        }
+        auto index = static_cast<std::uint32_t>(entries.size());
+        entries.push_back(p);
+        hashes.push_back(hash);
+        alive.push_back(1);
+        ++map_size;
+        std::uint32_t homeless = place(index);
+        if (homeless != EMPTY) {
+            grow(homeless);
+            index = static_cast<std::uint32_t>(entries.size() - 1);
+        }
+        return std::pair<Iterator, bool>(Iterator(this, index), true);
+    }
+
+    std::size_t erase(const Key & key) {
+        if (!remove(key)) {
+            return 0;
+        }
+        if (sparse()) {
+            rehash(capacity);
+        }
+        return 1;
+    }
+
+    Iterator erase(const Iterator & it) {
+        if (it == end()) return end();
+        Iterator next = it;
+        ++next;
+        remove(entries[it.index].first);
+        if (sparse()) {
+            // the live entries keep their order but move down
+            auto live = std::count(alive.begin(), alive.begin() + next.index, 1);
+            rehash(capacity);
+            next = Iterator(this, live);
+        }
+        return next;
+    }
+
+    Iterator find(const Key & key) {
+        migrate(migrate_step);
+        Bucket* bucket;
+        int w = findSlot(key, getHashes(key), bucket);
+        return w >= 0 ? Iterator(this, bucket->index[w]) : end();
+    }
+
+    /**
+     * Find all keys of the batch. The keys of a group are hashed and both
+     * candidate buckets of each are prefetched, then the entries whose tags
+     * matched, and only then the keys are compared, so the memory accesses
+     * of the group overlap.
+     * @param keys
+     * @param out       iterator for each key, end() for absent keys
+     */
+    void find_batch(std::span<const Key> keys, std::span<Iterator> out) {
+        constexpr std::size_t GROUP = 16;
+        Hashes hash[GROUP];
+        for (std::size_t start = 0; start < keys.size(); start += GROUP) {
+            migrate(migrate_step);
+            std::size_t len = std::min(GROUP, keys.size() - start);
+            for (std::size_t i = 0; i < len; ++i) {
+                hash[i] = getHashes(keys[start + i]);
+                __builtin_prefetch(&tab1[getHash1(hash[i])]);
+                __builtin_prefetch(&tab2[getHash2(hash[i])]);
+            }
+            for (std::size_t i = 0; i < len; ++i) {
+                std::uint8_t tag = getTag(hash[i]);
+                for (const Bucket* bucket : {&tab1[getHash1(hash[i])], &tab2[getHash2(hash[i])]}) {
+                    for (std::uint64_t found = bucket->match(tag); found; found &= found - 1) {
+                        __builtin_prefetch(&entries[bucket->index[std::countr_zero(found) / 8]]);
+                    }
+                }
+            }
+            for (std::size_t i = 0; i < len; ++i) {
+                Bucket* bucket;
+                int w = findSlot(keys[start + i], hash[i], bucket);
+                out[start + i] = w >= 0 ? Iterator(this, bucket->index[w]) : end();
+            }
+        }
+    }
+
+    /**
+     * Insert all pairs of the batch, prefetching the buckets of a group
+     * of keys before inserting them one by one
+     * @param pairs
+     * @return          number of inserted keys
+     */
+    std::size_t insert_batch(std::span<const std::pair<Key, Value>> pairs) {
+        constexpr std::size_t GROUP = 16;
+        std::size_t inserted = 0;
+        for (std::size_t start = 0; start < pairs.size(); start += GROUP) {
+            std::size_t len = std::min(GROUP, pairs.size() - start);
+            for (std::size_t i = 0; i < len; ++i) {
+                Hashes hash = getHashes(pairs[start + i].first);
+                __builtin_prefetch(&tab1[getHash1(hash)]);
+                __builtin_prefetch(&tab2[getHash2(hash)]);
+            }
+            for (std::size_t i = 0; i < len; ++i) {
+                inserted += insert(pairs[start + i]).second;
+            }
+        }
+        return inserted;
+    }
+
+    ConstIterator find(const Key & key) const {
+        Bucket* bucket;
+        int w = const_cast<FlatUnorderedMap*>(this)->findSlot(key, getHashes(key), bucket);
+        return w >= 0 ? ConstIterator(this, bucket->index[w]) : end();
+    }
+
+    Iterator begin() {
+        Iterator it(this, 0);
+        it.skip();
+        return it;
+    }
+    Iterator end() {
+        return Iterator(this, entries.size());
+    }
+    ConstIterator begin() const {
+        ConstIterator it(this, 0);
+        it.skip();
+        return it;
+    }
+    ConstIterator end() const {
+        return ConstIterator(this, entries.size());
+    }
+
+    std::size_t size() const {
+        return map_size;
+    }
+
+    std::size_t bucket_count() const {
+        return 2 * capacity;
+    }
+
+    std::size_t rehashes() const {
+        return rehash_count;
+    }
+
+    double load_factor() const {
+        return static_cast<double>(map_size) / static_cast<double>(2 * capacity * Ways);
+    }
+
+    void clear() {
+        entries.clear(); hashes.clear(); alive.clear();
+        capacity = INITIAL_CAPACITY; map_size = 0;
+        shift = 64 - std::countr_zero(capacity);
+        std::vector<Bucket>().swap(old1);
+        std::vector<Bucket>().swap(old2);
+        migrate_next = migrate_end = 0;
+        tab1.assign(capacity, Bucket());
+        tab2.assign(capacity, Bucket());
+    }
+
+    Value& operator[](const Key & key) {
+        Iterator it = find(key);
+        if (it == end()) {
+            std::pair<Key, Value> p;
+            p.first = key;
+            it = insert(p).first;
+        }
+        return it->second;
+    }
+};
+
+template <class Key, class Value, int Ways, class Hash1, class Hash2>
+template <bool Const>
+class FlatUnorderedMap<Key, Value, Ways, Hash1, Hash2>::BasicIterator
+{
+    using Map = std::conditional_t<Const, const FlatUnorderedMap, FlatUnorderedMap>;
+    using Pair = std::conditional_t<Const, const std::pair<Key, Value>, std::pair<Key, Value>>;
+    friend class FlatUnorderedMap;
+
+    void skip() {
+        while (index < map->entries.size() && !map->alive[index]) {
+            ++index;
+        }
+    }
+
+public:
+    Map* map = nullptr;
+    std::size_t index = 0;
+
+    BasicIterator() = default;
+    BasicIterator(Map* _map, std::size_t _index) : map(_map), index(_index) { }
+    template <bool C = Const> requires C
+    BasicIterator(const BasicIterator<false>& it) : map(it.map), index(it.index) { }
+
+    Pair& operator*() const {
+        return map->entries[index];
+    }
+    Pair* operator->() const {
+        return &map->entries[index];
+    }
+    BasicIterator& operator++() {
+        ++index;
+        skip();
+        return *this;
+    }
+    BasicIterator operator++(int) {
+        BasicIterator old_it = *this;
+        ++*this;
+        return old_it;
+    }
+    friend bool operator==(const BasicIterator& it1, const BasicIterator& it2) {
+        return it1.index == it2.index;
+    }
+    friend bool operator!=(const BasicIterator& it1, const BasicIterator& it2) {
+        return it1.index != it2.index;
+    }
+};
+
+#endif //ALGORITHMS_FLAT_UNORDERED_MAP_HPP
@@ -0,0 +1,311 @@
+/**
+ * Read-only snapshot of an UnorderedMap in a flat binary image which can be
+ * written to a file and mapped back into memory with mmap. The image holds
+ * a header, the two cuckoo tables as 32-bit indices and a contiguous array
+ * of key/value entries. All positions are offsets from the beginning
+ * of the image, so find works directly on the mapped pages
+ * without any deserialization.
+ *
+ * Keys and values have to be trivially copyable. The image uses the byte
+ * order and type sizes of the machine that wrote it; the sizes are checked
+ * when the image is opened.
+ */
+
+#ifndef ALGORITHMS_FROZEN_UNORDERED_MAP_HPP
+#define ALGORITHMS_FROZEN_UNORDERED_MAP_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "unordered_map.hpp"
+
+template <class Key, class Value, class Hash1 = MultiplyShiftHash<Key>, class Hash2 = WyHash<Key>>
+class FrozenUnorderedMap {
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "frozen map stores keys and values as raw bytes");
+
+public:
+    struct Entry {
+        Key key;
+        Value value;
+    };
+    static_assert(alignof(Entry) <= alignof(std::max_align_t));
+
+private:
+    static constexpr char MAGIC[8] = {'C', 'U', 'C', 'K', 'O', 'O', 'F', 'Z'};
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr std::uint32_t EMPTY = UINT32_MAX;
+    static constexpr std::size_t ALIGN = 64;
+    static constexpr std::uint64_t MIN_CAPACITY = 128;     // of an UnorderedMap
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t key_size;
+        std::uint32_t value_size;
+        std::uint32_t entry_size;
+        std::uint64_t size;
+        std::uint64_t capacity;
+        std::uint64_t seed;
+        std::uint64_t shift;
+        std::uint64_t tab1_offset;
+        std::uint64_t tab2_offset;
+        std::uint64_t entries_offset;
+        std::uint64_t image_size;
+    };
+
+    const unsigned char* image = nullptr;
+    std::size_t mapped_size = 0;
+    std::size_t map_size = 0;
+    int shift = 0;
+    const std::uint32_t* tab1 = nullptr;
+    const std::uint32_t* tab2 = nullptr;
+    const Entry* entries = nullptr;
+    Hash1 hash1;
+    Hash2 hash2;
+
+    static std::size_t alignUp(std::size_t offset) {
+        return (offset + ALIGN - 1) / ALIGN * ALIGN;
+    }
+
+    static Header layout(std::size_t size, std::size_t capacity, std::uint64_t seed, int shift) {
+        Header h{};
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.key_size = sizeof(Key);
+        h.value_size = sizeof(Value);
+        h.entry_size = sizeof(Entry);
+        h.size = size;
+        h.capacity = capacity;
+        h.seed = seed;
+        h.shift = shift;
+        h.tab1_offset = alignUp(sizeof(Header));
+        h.tab2_offset = alignUp(h.tab1_offset + capacity * sizeof(std::uint32_t));
+        h.entries_offset = alignUp(h.tab2_offset + capacity * sizeof(std::uint32_t));
+        h.image_size = h.entries_offset + size * sizeof(Entry);
+        return h;
+    }
+
+    void attach(const void* data, std::size_t size) {
+        if (reinterpret_cast<std::uintptr_t>(data) % alignof(std::max_align_t) != 0) {
+            throw std::invalid_argument("Frozen map image is misaligned");
+        }
+        if (size < sizeof(Header)) {
+            throw std::runtime_error("Frozen map image is truncated");
+        }
+        Header h;
+        std::memcpy(&h, data, sizeof(Header));
+        if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION) {
+            throw std::runtime_error("Not a frozen map image");
+        }
+        if (h.key_size != sizeof(Key) || h.value_size != sizeof(Value) || h.entry_size != sizeof(Entry)) {
+            throw std::runtime_error("Frozen map image has different key or value types");
+        }
+        Header expected = layout(h.size, h.capacity, h.seed, static_cast<int>(h.shift));
+        if (h.capacity < MIN_CAPACITY || (h.capacity & (h.capacity - 1)) != 0 || h.shift != 64 - static_cast<std::uint64_t>(std::countr_zero(h.capacity)) ||
+            h.tab1_offset != expected.tab1_offset || h.tab2_offset != expected.tab2_offset ||
+            h.entries_offset != expected.entries_offset || h.image_size != expected.image_size || size < h.image_size) {
+            throw std::runtime_error("Frozen map image is corrupted");
+        }
+        auto* bytes = static_cast<const unsigned char*>(data);
+        auto* t1 = reinterpret_cast<const std::uint32_t*>(bytes + h.tab1_offset);
+        auto* t2 = reinterpret_cast<const std::uint32_t*>(bytes + h.tab2_offset);
+        auto valid = [&h](std::uint32_t index) { return index == EMPTY || index < h.size; };
+        if (!std::all_of(t1, t1 + h.capacity, valid) || !std::all_of(t2, t2 + h.capacity, valid)) {
+            throw std::runtime_error("Frozen map image is corrupted");
+        }
+        image = bytes;
+        map_size = h.size;
+        shift = static_cast<int>(h.shift);
+        tab1 = t1;
+        tab2 = t2;
+        entries = reinterpret_cast<const Entry*>(image + h.entries_offset);
+        hash1 = Hash1(h.seed);
+        hash2 = Hash2(h.seed + 1);
+    }
+
+    void unmap() {
+        if (mapped_size > 0) {
+            munmap(const_cast<unsigned char*>(image), mapped_size);
+        }
+        image = nullptr;
+        mapped_size = 0;
+    }
+
+public:
+    FrozenUnorderedMap() : hash1(0), hash2(1) { }
+
+    /**
+     * View an image kept in memory by the caller, e.g. one returned by freeze.
+     * The data must be aligned as std::max_align_t and outlive the map.
+     * The header and the table indices are validated in O(capacity).
+     * @param data
+     * @param size      size of the data in bytes
+     */
+    FrozenUnorderedMap(const void* data, std::size_t size) : hash1(0), hash2(1) {
+        attach(data, size);
+    }
+
+    FrozenUnorderedMap(const FrozenUnorderedMap &) = delete;
+    FrozenUnorderedMap& operator=(const FrozenUnorderedMap &) = delete;
+    FrozenUnorderedMap(FrozenUnorderedMap && m) noexcept : hash1(0), hash2(1) {
+        swap(m);
+    }
+    FrozenUnorderedMap& operator=(FrozenUnorderedMap && m) noexcept {
+        swap(m);
+        return *this;
+    }
+    ~FrozenUnorderedMap() {
+        unmap();
+    }
+
+    void swap(FrozenUnorderedMap & m) noexcept {
+        std::swap(image, m.image);
+        std::swap(mapped_size, m.mapped_size);
+        std::swap(map_size, m.map_size);
+        std::swap(shift, m.shift);
+        std::swap(tab1, m.tab1);
+        std::swap(tab2, m.tab2);
+        std::swap(entries, m.entries);
+        std::swap(hash1, m.hash1);
+        std::swap(hash2, m.hash2);
+    }
+
+    /**
+     * Build the image of the map. The tables keep the positions of the keys
+     * in the map, so opening the image needs no rehashing. Entries are
+     * stored in the iteration order of the map.
+     * @param map
+     * @return      the image
+     */
+    template <class Allocator>
+    static std::vector<std::max_align_t> freeze(UnorderedMap<Key, Value, Hash1, Hash2, Allocator> & map) {
+        if (map.size() >= EMPTY) {
+            throw std::length_error("Map is too large to be frozen");
+        }
+        Header h = layout(map.size(), map.capacity, map.seed, map.shift);
+        std::vector<std::max_align_t> buffer((h.image_size + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t));
+        auto* data = reinterpret_cast<unsigned char*>(buffer.data());
+        std::memcpy(data, &h, sizeof(Header));
+        auto* t1 = reinterpret_cast<std::uint32_t*>(data + h.tab1_offset);
+        auto* t2 = reinterpret_cast<std::uint32_t*>(data + h.tab2_offset);
+        auto* e = reinterpret_cast<Entry*>(data + h.entries_offset);
+        std::fill_n(t1, h.capacity, EMPTY);
+        std::fill_n(t2, h.capacity, EMPTY);
+        std::uint32_t i = 0;
+        // the buffer is zeroed and only the fields are copied, so the padding
+        // of the entries is zero and equal maps give equal images
+        for (auto node = map.begin().tmp; node != map.end().tmp; node = node->next, ++i) {
+            std::memcpy(&e[i].key, &node->p.first, sizeof(Key));
+            std::memcpy(&e[i].value, &node->p.second, sizeof(Value));
+            std::size_t h1 = map.getHash1(node->p.first);
+            if (map.tab1[h1] == node) {
+                t1[h1] = i;
+            } else {
+                t2[map.getHash2(node->p.first)] = i;
+            }
+        }
+        return buffer;
+    }
+
+    /**
+     * Write the image of the map to a file
+     * @param map
+     * @param path
+     */
+    template <class Allocator>
+    static void write(UnorderedMap<Key, Value, Hash1, Hash2, Allocator> & map, const std::string & path) {
+        auto buffer = freeze(map);
+        Header h;
+        std::memcpy(&h, buffer.data(), sizeof(Header));
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(h.image_size));
+        if (!out) {
+            throw std::runtime_error("Cannot write frozen map to " + path);
+        }
+    }
+
+    /**
+     * Map the image from a file read-only into memory. The tables are read
+     * once to check that every index is in range, the pages of the entries
+     * are loaded lazily on first access.
+     * @param path
+     * @return      the map, valid until it is destroyed
+     */
+    static FrozenUnorderedMap open(const std::string & path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open frozen map " + path);
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot read frozen map " + path);
+        }
+        auto size = static_cast<std::size_t>(st.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Cannot map frozen map " + path);
+        }
+        FrozenUnorderedMap m;
+        m.mapped_size = size;
+        m.image = static_cast<const unsigned char*>(data);
+        m.attach(data, size);
+        return m;
+    }
+
+    /**
+     * @param key
+     * @return      pointer to the value of the key or nullptr if it is absent
+     */
+    const Value* find(const Key & key) const {
+        std::uint32_t i = tab1[hash1(key) >> shift];
+        if (i != EMPTY && entries[i].key == key) {
+            return &entries[i].value;
+        }
+        i = tab2[hash2(key) >> shift];
+        if (i != EMPTY && entries[i].key == key) {
+            return &entries[i].value;
+        }
+        return nullptr;
+    }
+
+    const Value & at(const Key & key) const {
+        const Value* value = find(key);
+        if (value == nullptr) {
+            throw std::out_of_range("Key is not in the frozen map");
+        }
+        return *value;
+    }
+
+    bool contains(const Key & key) const {
+        return find(key) != nullptr;
+    }
+
+    std::size_t size() const {
+        return map_size;
+    }
+
+    /**
+     * @return      all entries in the iteration order of the frozen map
+     */
+    std::span<const Entry> items() const {
+        return std::span<const Entry>(entries, map_size);
+    }
+};
+
+#endif //ALGORITHMS_FROZEN_UNORDERED_MAP_HPP
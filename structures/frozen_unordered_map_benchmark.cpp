@@ -0,0 +1,66 @@
+#include "unordered_map.hpp"
+#include "frozen_unordered_map.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * Startup time of a map of n random keys: building it with insert
+ * against opening its frozen image with mmap, and the first lookups
+ * which fault the pages of the image in
+ */
+int main(int argc, char* argv[]) {
+    using K = std::uint64_t;
+    int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    std::string path = argc > 2 ? argv[2] : (std::filesystem::temp_directory_path() / "frozen_unordered_map.bin").string();
+    int lookups = 1000000;
+
+    std::mt19937_64 gen(2024);
+    std::vector<K> keys(n);
+    for (auto & key : keys) {
+        key = gen();
+    }
+
+    auto start = Clock::now();
+    UnorderedMap<K, K> map;
+    for (int i = 0; i < n; i++) {
+        map.insert({keys[i], static_cast<K>(i)});
+    }
+    std::cout << "Build with insert: " << elapsed_ms(start) << " ms, " << map.rehash_count << " rehashes" << std::endl;
+
+    start = Clock::now();
+    FrozenUnorderedMap<K, K>::write(map, path);
+    std::cout << "Freeze and write: " << elapsed_ms(start) << " ms, "
+              << std::filesystem::file_size(path) / (1 << 20) << " MiB" << std::endl;
+
+    start = Clock::now();
+    auto frozen = FrozenUnorderedMap<K, K>::open(path);
+    std::cout << "Open with mmap: " << elapsed_ms(start) << " ms" << std::endl;
+
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    K sum = 0;
+    start = Clock::now();
+    for (int i = 0; i < lookups; i++) {
+        sum += *frozen.find(keys[pick(gen)]);
+    }
+    std::cout << lookups << " lookups in the frozen map: " << elapsed_ms(start) << " ms" << std::endl;
+
+    start = Clock::now();
+    for (int i = 0; i < lookups; i++) {
+        sum += map.find(keys[pick(gen)])->second;
+    }
+    std::cout << lookups << " lookups in the built map: " << elapsed_ms(start) << " ms (checksum " << sum << ")" << std::endl;
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,171 @@
+/**
+ * Hash functions for the hash tables of unordered maps. Each hasher is
+ * constructed with a seed and returns a 64-bit hash whose highest bits
+ * are of the best quality, so a table of 2^k buckets takes the top k bits
+ * of the hash as the index instead of computing a modulo.
+ *
+ * MultiplyShiftHash is the multiply-shift scheme (a*x + b) for random odd a,
+ * a universal family that costs one multiplication per key.
+ * WyHash mixes 64-bit words with a 128-bit multiplication as in wyhash
+ * and is also used to hash strings byte by byte.
+ * The hashers of std::string take std::string_view and are transparent,
+ * so anything convertible to std::string_view hashes like the equal string.
+ */
+
+#ifndef ALGORITHMS_HASHING_HPP
+#define ALGORITHMS_HASHING_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace hashing {
+
+constexpr std::uint64_t WYP0 = 0x2d358dccaa6c78a5ull;
+constexpr std::uint64_t WYP1 = 0x8bb84b93962eacc9ull;
+constexpr std::uint64_t WYP2 = 0x4b33a62ed433d4a3ull;
+constexpr std::uint64_t WYP3 = 0x4d5a2da51de1aa47ull;
+
+/**
+ * Derive a well-mixed 64-bit value from the seed (splitmix64)
+ */
+inline std::uint64_t splitmix(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+inline std::uint64_t wymix(std::uint64_t a, std::uint64_t b) {
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+}
+
+inline std::uint64_t read8(const unsigned char* p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline std::uint64_t read4(const unsigned char* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+/**
+ * Hash a sequence of bytes with the wyhash algorithm
+ * @param data
+ * @param len       number of bytes
+ * @param seed
+ * @return          64-bit hash
+ */
+inline std::uint64_t wyhash(const void* data, std::size_t len, std::uint64_t seed) {
+    auto p = static_cast<const unsigned char*>(data);
+    seed ^= wymix(seed ^ WYP0, WYP1);
+    std::uint64_t a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (read4(p) << 32) | read4(p + ((len >> 3) << 2));
+            b = (read4(p + len - 4) << 32) | read4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = (static_cast<std::uint64_t>(p[0]) << 16) | (static_cast<std::uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        std::size_t i = len;
+        if (i > 48) {
+            std::uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = wymix(read8(p) ^ WYP1, read8(p + 8) ^ seed);
+                see1 = wymix(read8(p + 16) ^ WYP2, read8(p + 24) ^ see1);
+                see2 = wymix(read8(p + 32) ^ WYP3, read8(p + 40) ^ see2);
+                p += 48; i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = wymix(read8(p) ^ WYP1, read8(p + 8) ^ seed);
+            p += 16; i -= 16;
+        }
+        a = read8(p + i - 16);
+        b = read8(p + i - 8);
+    }
+    return wymix(WYP1 ^ len, wymix(a ^ WYP1, b ^ seed));
+}
+
+/**
+ * Reduce the key to a 64-bit word: integers and enums are taken as they are,
+ * other types go through std::hash
+ */
+template <class Key>
+std::uint64_t toWord(const Key & key) {
+    if constexpr (std::is_integral_v<Key> || std::is_enum_v<Key>) {
+        return static_cast<std::uint64_t>(key);
+    } else {
+        return std::hash<Key>()(key);
+    }
+}
+
+} // namespace hashing
+
+template <class Key>
+class MultiplyShiftHash {
+    std::uint64_t a, b;
+
+public:
+    explicit MultiplyShiftHash(std::uint64_t seed = 0)
+        : a(hashing::splitmix(seed) | 1), b(hashing::splitmix(seed ^ hashing::WYP0)) { }
+
+    std::uint64_t operator()(const Key & key) const {
+        return a * hashing::toWord(key) + b;
+    }
+};
+
+template <class Key>
+class WyHash {
+    std::uint64_t seed;
+
+public:
+    explicit WyHash(std::uint64_t _seed = 0) : seed(hashing::splitmix(_seed)) { }
+
+    std::uint64_t operator()(const Key & key) const {
+        return hashing::wymix(hashing::toWord(key) ^ seed ^ hashing::WYP0, hashing::WYP1);
+    }
+};
+
+template <>
+class MultiplyShiftHash<std::string> {
+    std::uint64_t a, b;
+
+public:
+    using is_transparent = void;
+
+    explicit MultiplyShiftHash(std::uint64_t seed = 0)
+        : a(hashing::splitmix(seed) | 1), b(hashing::splitmix(seed ^ hashing::WYP0)) { }
+
+    std::uint64_t operator()(std::string_view key) const {
+        return a * std::hash<std::string_view>()(key) + b;
+    }
+};
+
+template <>
+class WyHash<std::string> {
+    std::uint64_t seed;
+
+public:
+    using is_transparent = void;
+
+    explicit WyHash(std::uint64_t _seed = 0) : seed(hashing::splitmix(_seed)) { }
+
+    std::uint64_t operator()(std::string_view key) const {
+        return hashing::wyhash(key.data(), key.size(), seed);
+    }
+};
+
+#endif //ALGORITHMS_HASHING_HPP
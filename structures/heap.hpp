@@ -3,38 +3,96 @@
  * defining the ordering of elements. The heap can be used as a min-heap
  * or a max-heap or any other depending on the comparator provided. The class
  * supports basic heap operations such as insertion, extraction of the top
- * element, and peeking at the top element.
+ * element, and peeking at the top element. A heap can be built from
+ * a vector or a range in O(n) with Floyd's algorithm, and many elements
+ * can be added or removed at once. The array of elements
+ * is allocated with Allocator.
  */
 
 #ifndef ALGORITHMS_HEAP_HPP
 #define ALGORITHMS_HEAP_HPP
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <ranges>
 #include <utility>
 #include <functional>
 #include <vector>
 #include <stdexcept>
+#include <type_traits>
 
-template<typename T, typename Compare = std::less<T>>
+template<typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
 class Heap {
-    std::vector<T> H;
-    int _size = 0;
+    std::vector<T, Allocator> H;
     Compare compare;
 
+    /**
+     * Arrange the whole array into a heap with Floyd's algorithm,
+     * sifting down every inner node from the last one, in O(n)
+     */
+    void heapify() {
+        for (int i = size() / 2 - 1; i >= 0; --i) {
+            makeHeap(i);
+        }
+    }
+
 public:
-    Heap() : H(8), compare(Compare()) { }
-    explicit Heap(int capacity, Compare comp = Compare()) : H(capacity), compare(comp) { }
+    Heap() : compare(Compare()) {
+        H.reserve(8);
+    }
+    explicit Heap(const Allocator & alloc) : H(alloc), compare(Compare()) {
+        H.reserve(8);
+    }
+    explicit Heap(int capacity, Compare comp = Compare(), const Allocator & alloc = Allocator())
+        : H(alloc), compare(comp) {
+        H.reserve(capacity);
+    }
+    /**
+     * Adopt the elements of the vector and heapify them in O(n)
+     * @param elements
+     * @param comp
+     */
+    explicit Heap(std::vector<T, Allocator> && elements, Compare comp = Compare())
+        : H(std::move(elements)), compare(comp) {
+        heapify();
+    }
+    /**
+     * Build the heap from the elements of [first, last) in O(n)
+     */
+    template <std::input_iterator It>
+    Heap(It first, It last, Compare comp = Compare(), const Allocator & alloc = Allocator())
+        : H(first, last, alloc), compare(comp) {
+        heapify();
+    }
+    Heap(const Heap &) = default;
+    Heap(Heap && h) noexcept : H(std::move(h.H)), compare(std::move(h.compare)) {
+        h.H.clear();
+    }
+    Heap& operator=(const Heap &) = default;
+    Heap& operator=(Heap && h) noexcept {
+        H = std::move(h.H);
+        h.H.clear();
+        compare = std::move(h.compare);
+        return *this;
+    }
 
     int size() const {
-        return _size;
+        return static_cast<int>(H.size());
+    }
+
+    void reserve(int capacity) {
+        H.reserve(capacity);
     }
 
     void makeHeap(int i) {
-        int max_i = i;
-        while (2*i+1 < _size) {
+        int max_i = i, n = size();
+        while (2*i+1 < n) {
             if (compare(H[max_i], H[2*i+1])) {
                 max_i = 2*i+1;
             }
-            if (2*i+2 < _size && compare(H[max_i], H[2*i+2])) {
+            if (2*i+2 < n && compare(H[max_i], H[2*i+2])) {
                 max_i = 2*i+2;
             }
             if (compare(H[i], H[max_i])) {
@@ -45,33 +103,111 @@ public:
     }
 
     T pop() {
-        if (_size == 0) {
+        if (H.empty()) {
             throw std::out_of_range("Heap is empty");
         }
-        T root = H[0];
-        H[0] = H[--_size];
-        makeHeap(0);
+        T root = std::move(H[0]);
+        if (H.size() > 1) {
+            H[0] = std::move(H.back());
+            H.pop_back();
+            makeHeap(0);
+        } else {
+            H.pop_back();
+        }
         return root;
     }
 
-    T top() const {
-        if (_size == 0) {
+    /**
+     * Remove the k elements from the top, or all if there are fewer,
+     * or none if k is negative.
+     * For small k they are popped one by one in O(k log n); otherwise
+     * the k top elements are selected in one pass over the array, sorted,
+     * and the rest is heapified again in O(n + k log k).
+     * @param k
+     * @return      the removed elements in the order pop would return them
+     */
+    std::vector<T> pop_n(int k) {
+        k = std::clamp(k, 0, size());
+        std::vector<T> top_k;
+        top_k.reserve(k);
+        if (static_cast<double>(k) * std::log2(size() + 1.0) < 2.0 * size()) {
+            while (static_cast<int>(top_k.size()) < k) {
+                top_k.push_back(pop());
+            }
+            return top_k;
+        }
+        auto first = [this](const T & a, const T & b) { return compare(b, a); };
+        std::nth_element(H.begin(), H.begin() + k, H.end(), first);
+        std::sort(H.begin(), H.begin() + k, first);
+        std::move(H.begin(), H.begin() + k, std::back_inserter(top_k));
+        H.erase(H.begin(), H.begin() + k);
+        heapify();
+        return top_k;
+    }
+
+    const T & top() const {
+        if (H.empty()) {
             throw std::out_of_range("Heap is empty");
         }
         return H[0];
     }
 
-    void insert(T key) {
-        if (_size == H.size()) {
-            H.resize(_size * 2);
-        }
-        H[_size] = key;
-        int i = _size++;
+    void siftUp(int i) {
         while (i > 0 && compare(H[(i-1)/2], H[i])) {
             std::swap(H[i], H[(i-1)/2]);
             i = (i-1)/2;
         }
     }
+
+    void insert(const T & key) {
+        H.push_back(key);
+        siftUp(size() - 1);
+    }
+
+    void insert(T && key) {
+        H.push_back(std::move(key));
+        siftUp(size() - 1);
+    }
+
+    /**
+     * Construct the element from args and add it to the heap
+     * @param args      arguments of the T constructor
+     */
+    template <class... Args>
+    void emplace(Args&&... args) {
+        H.emplace_back(std::forward<Args>(args)...);
+        siftUp(size() - 1);
+    }
+
+    /**
+     * Add all elements of the range, moving them if the range is an rvalue
+     * that owns its elements; views and borrowed ranges are copied from.
+     * If the range is large compared to the heap, the whole array is
+     * heapified again in O(n + k), otherwise the new elements
+     * are sifted up one by one in O(k log n).
+     * @param range
+     */
+    template <std::ranges::input_range R>
+    void push_range(R && range) {
+        int old_size = size();
+        constexpr bool owning = !std::is_lvalue_reference_v<R> && !std::ranges::borrowed_range<R>
+                                && !std::ranges::view<std::remove_cvref_t<R>>;
+        for (auto && x : range) {
+            if constexpr (owning) {
+                H.push_back(std::move(x));
+            } else {
+                H.push_back(std::forward<decltype(x)>(x));
+            }
+        }
+        int k = size() - old_size;
+        if (static_cast<double>(k) * std::log2(size() + 1.0) > 2.0 * size()) {
+            heapify();
+        } else {
+            for (int i = old_size; i < size(); ++i) {
+                siftUp(i);
+            }
+        }
+    }
 };
 
 #endif //ALGORITHMS_HEAP_HPP
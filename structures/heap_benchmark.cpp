@@ -0,0 +1,116 @@
+#include "heap.hpp"
+#include "dary_heap.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * Push n random keys and pop them all, repeated so that at least
+ * 10M keys pass through the heap; prints millions of operations per second
+ */
+template <class HeapType>
+void bench(const std::string & name, const std::vector<std::uint32_t> & keys) {
+    std::size_t n = keys.size();
+    std::size_t rounds = std::max<std::size_t>(1, 10000000 / n);
+    std::uint64_t checksum = 0;
+    double push_ms = 0, pop_ms = 0;
+    for (std::size_t r = 0; r < rounds; r++) {
+        HeapType heap;
+        auto start = Clock::now();
+        for (auto key : keys) {
+            heap.insert(key);
+        }
+        push_ms += elapsed_ms(start);
+        start = Clock::now();
+        while (heap.size() > 0) {
+            checksum += heap.pop();
+        }
+        pop_ms += elapsed_ms(start);
+    }
+    double ops = static_cast<double>(n * rounds) / 1000.0;
+    std::cout << "  " << name << ": push " << ops / push_ms << " M/s, pop " << ops / pop_ms
+              << " M/s (checksum " << checksum % 1000 << ")" << std::endl;
+}
+
+/**
+ * Building a Heap by n inserts against heapifying a moved vector,
+ * and popping the top tenth one by one against pop_n
+ */
+void bench_bulk(const std::vector<std::uint32_t> & keys) {
+    int n = static_cast<int>(keys.size());
+    auto start = Clock::now();
+    Heap<std::uint32_t> inserted;
+    for (auto key : keys) {
+        inserted.insert(key);
+    }
+    double insert_ms = elapsed_ms(start);
+    std::vector<std::uint32_t> copy = keys;
+    start = Clock::now();
+    Heap<std::uint32_t> heapified(std::move(copy));
+    double heapify_ms = elapsed_ms(start);
+    std::cout << "  build: " << insert_ms << " ms by insert, " << heapify_ms << " ms by heapify" << std::endl;
+    std::vector<std::uint32_t> ascending = keys;
+    std::sort(ascending.begin(), ascending.end());
+    start = Clock::now();
+    Heap<std::uint32_t> worst;
+    for (auto key : ascending) {
+        worst.insert(key);
+    }
+    insert_ms = elapsed_ms(start);
+    start = Clock::now();
+    Heap<std::uint32_t> worst_heapified(std::move(ascending));
+    heapify_ms = elapsed_ms(start);
+    std::cout << "  build from ascending keys: " << insert_ms << " ms by insert, "
+              << heapify_ms << " ms by heapify" << std::endl;
+
+    int k = n / 10;
+    std::uint64_t checksum = 0;
+    start = Clock::now();
+    for (int i = 0; i < k; i++) {
+        checksum += inserted.pop();
+    }
+    double pop_ms = elapsed_ms(start);
+    start = Clock::now();
+    for (auto key : heapified.pop_n(k)) {
+        checksum -= key;
+    }
+    double pop_n_ms = elapsed_ms(start);
+    std::cout << "  top " << k << ": " << pop_ms << " ms by pop, " << pop_n_ms << " ms by pop_n"
+              << (checksum == 0 ? "" : " (mismatch!)") << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {1000, 1000000, 100000000};
+    }
+    std::mt19937 gen(2024);
+    for (std::size_t n : sizes) {
+        std::vector<std::uint32_t> keys(n);
+        for (auto & key : keys) {
+            key = gen();
+        }
+        std::cout << n << " elements" << std::endl;
+        bench<Heap<std::uint32_t, std::greater<>>>("Heap (binary, swap)", keys);
+        bench<DaryHeap<std::uint32_t, std::greater<>, 2>>("DaryHeap<2>", keys);
+        bench<DaryHeap<std::uint32_t, std::greater<>, 4>>("DaryHeap<4>", keys);
+        bench<DaryHeap<std::uint32_t, std::greater<>, 8>>("DaryHeap<8>", keys);
+        bench_bulk(keys);
+    }
+    return 0;
+}
@@ -0,0 +1,208 @@
+/**
+ * Implementation of an addressable heap with custom comparator. Like Heap,
+ * the element for which the comparator says it is not less than any other
+ * is on the top (a max-heap for std::less). Insertion returns a handle
+ * that identifies the element until it is removed, and the position map
+ * from handles to places in the heap allows to change the key of
+ * an element or to erase it in O(log n).
+ * Handles of removed elements are reused by later insertions.
+ */
+
+#ifndef ALGORITHMS_INDEXED_HEAP_HPP
+#define ALGORITHMS_INDEXED_HEAP_HPP
+
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+template<typename T, typename Compare = std::less<T>>
+class IndexedHeap {
+    struct Entry {
+        T key;
+        int handle;
+    };
+    std::vector<Entry> H;
+    std::vector<int> pos;        // place of the handle in H, -1 if it is free
+    std::vector<int> free_handles;
+    Compare compare;
+
+    void place(int i, Entry && e) {
+        pos[e.handle] = i;
+        H[i] = std::move(e);
+    }
+
+    /**
+     * Move the entry at i up, shifting the parents down into the hole
+     */
+    void siftUp(int i) {
+        Entry e = std::move(H[i]);
+        while (i > 0 && compare(H[(i-1)/2].key, e.key)) {
+            place(i, std::move(H[(i-1)/2]));
+            i = (i-1)/2;
+        }
+        place(i, std::move(e));
+    }
+
+    void siftDown(int i) {
+        Entry e = std::move(H[i]);
+        int n = size();
+        while (2*i+1 < n) {
+            int child = 2*i+1;
+            if (child+1 < n && compare(H[child].key, H[child+1].key)) {
+                ++child;
+            }
+            if (!compare(e.key, H[child].key)) break;
+            place(i, std::move(H[child]));
+            i = child;
+        }
+        place(i, std::move(e));
+    }
+
+    void check(int handle) const {
+        if (!contains(handle)) {
+            throw std::out_of_range("Invalid heap handle");
+        }
+    }
+
+    int newHandle() {
+        if (!free_handles.empty()) {
+            int handle = free_handles.back();
+            free_handles.pop_back();
+            return handle;
+        }
+        pos.push_back(-1);
+        return static_cast<int>(pos.size()) - 1;
+    }
+
+    /**
+     * Remove the entry at i, whose key has been moved out or is not needed
+     */
+    void remove(int i) {
+        pos[H[i].handle] = -1;
+        free_handles.push_back(H[i].handle);
+        Entry last = std::move(H.back());
+        H.pop_back();
+        if (i < size()) {
+            bool up = i > 0 && compare(H[(i-1)/2].key, last.key);
+            place(i, std::move(last));
+            if (up) {
+                siftUp(i);
+            } else {
+                siftDown(i);
+            }
+        }
+    }
+
+public:
+    IndexedHeap() : compare(Compare()) { }
+    explicit IndexedHeap(int capacity, Compare comp = Compare()) : compare(comp) {
+        reserve(capacity);
+    }
+
+    void reserve(int capacity) {
+        H.reserve(capacity);
+        pos.reserve(capacity);
+    }
+
+    int size() const {
+        return static_cast<int>(H.size());
+    }
+
+    bool empty() const {
+        return H.empty();
+    }
+
+    /**
+     * @param handle
+     * @return          true if handle identifies an element in the heap
+     */
+    bool contains(int handle) const {
+        return handle >= 0 && handle < static_cast<int>(pos.size()) && pos[handle] >= 0;
+    }
+
+    /**
+     * Add the key to the heap
+     * @param key
+     * @return      handle of the new element
+     */
+    int insert(T key) {
+        int handle = newHandle();
+        H.push_back(Entry{std::move(key), handle});
+        siftUp(size() - 1);
+        return handle;
+    }
+
+    const T & top() const {
+        if (empty()) {
+            throw std::out_of_range("Heap is empty");
+        }
+        return H[0].key;
+    }
+
+    int top_handle() const {
+        if (empty()) {
+            throw std::out_of_range("Heap is empty");
+        }
+        return H[0].handle;
+    }
+
+    T pop() {
+        if (empty()) {
+            throw std::out_of_range("Heap is empty");
+        }
+        T root = std::move(H[0].key);
+        remove(0);
+        return root;
+    }
+
+    const T & get(int handle) const {
+        check(handle);
+        return H[pos[handle]].key;
+    }
+
+    /**
+     * Move the element towards the top by giving it a key which
+     * the comparator does not put before the old one (e.g. a smaller
+     * key for a min-heap ordered by std::greater)
+     * @param handle
+     * @param key
+     */
+    void decrease_key(int handle, T key) {
+        check(handle);
+        Entry & e = H[pos[handle]];
+        if (compare(key, e.key)) {
+            throw std::invalid_argument("New key is further from the top than the old one");
+        }
+        e.key = std::move(key);
+        siftUp(pos[handle]);
+    }
+
+    /**
+     * Change the key of the element in either direction
+     * @param handle
+     * @param key
+     */
+    void update(int handle, T key) {
+        check(handle);
+        Entry & e = H[pos[handle]];
+        bool up = !compare(key, e.key);
+        e.key = std::move(key);
+        if (up) {
+            siftUp(pos[handle]);
+        } else {
+            siftDown(pos[handle]);
+        }
+    }
+
+    /**
+     * Remove the element from the heap; its handle becomes invalid
+     * @param handle
+     */
+    void erase(int handle) {
+        check(handle);
+        remove(pos[handle]);
+    }
+};
+
+#endif //ALGORITHMS_INDEXED_HEAP_HPP
@@ -3,15 +3,57 @@
  * classes with any associative operation + for combining Values
  * and * for combining Modifiers and defined () operator for applying
  * the effect of Modifier on Value.
+ * Queries and updates walk the tree bottom-up without recursion, and batches
+ * of them are grouped by the blocks of leaves they touch; a Modifier has to
+ * distribute over +, i.e. m(a + b) = m(a) + m(b).
+ * A leaf may hold LeafSize consecutive values, e.g. 8 or 16, which divides
+ * the number of nodes and cuts the height of the tree by log2(LeafSize);
+ * the values of a leaf are then combined in a loop, which the compiler
+ * vectorizes when Value is arithmetic and + is thus plain addition.
+ * The inner nodes can be built level by level by several threads.
  */
 
 #ifndef ALGORITHMS_INTERVAL_TREE_HPP
 #define ALGORITHMS_INTERVAL_TREE_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-template<typename Value, typename Modifier>
+/**
+ * Placement of the nodes of IntervalTree in memory. Node v has children
+ * 2v and 2v+1, and the leaves are N..2N-1.
+ * Perfect:     N is n rounded up to a power of two and node v is stored
+ *              at index v, which takes up to 4n nodes.
+ * Compact:     N = n and node v is stored at index v, which takes 2n nodes.
+ *              The tree is a forest of perfect trees, and some inner nodes
+ *              combine leaves which are not contiguous, but queries and
+ *              updates only use the nodes of contiguous ranges.
+ * VanEmdeBoas: the perfect tree stored in the cache-oblivious order: the top
+ *              half of the levels is stored first, followed by the subtrees
+ *              below it, each stored recursively the same way. A root-to-leaf
+ *              path then touches O(log_B n) cache lines instead of
+ *              O(log n - log B), but the positions have to be computed, so it
+ *              pays off only when a cache miss costs more than this arithmetic,
+ *              e.g. for large nodes.
+ */
+enum class TreeLayout {
+    Perfect,
+    Compact,
+    VanEmdeBoas
+};
+
+template<typename Value, typename Modifier, TreeLayout Layout = TreeLayout::Perfect, std::size_t LeafSize = 1>
 class IntervalTree {
+    static_assert(LeafSize > 0, "A leaf has to hold at least one value");
+
     struct Node {
         Value val = Value();
         Modifier mod = Modifier();
@@ -24,74 +66,713 @@ class IntervalTree {
         }
     };
 
-    size_t N;
+    std::size_t N;
+    int levels;
     std::vector<Node> T;
+    std::vector<Value> elements;    // values of the leaves if LeafSize > 1, LeafSize per leaf
 
-    static int left(int v) {
+    static std::size_t leaves(std::size_t n) {
+        n = std::max<std::size_t>((n + LeafSize - 1) / LeafSize, 1);
+        return Layout == TreeLayout::Compact ? n : std::bit_ceil(n);
+    }
+
+    static std::size_t left(std::size_t v) {
         return 2*v;
     }
 
-    static int right(int v) {
+    static std::size_t right(std::size_t v) {
         return 2*v+1;
     }
 
-    Node query(std::size_t begin, std::size_t end, std::size_t l, std::size_t r, int v) const {
-        if (end <= l || r <= begin) return {};
-        if (begin <= l && r <= end) return T[v];
+    static int depth(std::size_t v) {
+        return std::bit_width(v) - 1;
+    }
+
+    /**
+     * Tables of the van Emde Boas order by depth. Every depth d > 0 is the
+     * depth of the roots of the bottom trees in one step of the recursive
+     * split; the subtree of the top tree root at depth top_depth is stored
+     * as its top tree of top_size nodes followed by the bottom trees.
+     */
+    struct VebLevel {
+        int top_depth = 0;
+        int bottom_height = 0;
+        std::size_t top_size = 0;
+        std::size_t mask = 0;       // selects the bottom tree from the node index
+    };
+    std::array<VebLevel, 64> veb{};
+
+    void vebSplit(int start, int h) {
+        if (h <= 1) return;
+        int top = h / 2, bottom = h - top;
+        veb[start + top] = { start, bottom, (std::size_t(1) << top) - 1, (std::size_t(1) << top) - 1 };
+        vebSplit(start, top);
+        vebSplit(start + top, bottom);
+    }
+
+    /**
+     * Offset of node v at depth d from the position of its top tree root:
+     * the top tree, then the bottom trees of 2^bottom_height - 1 nodes
+     */
+    std::size_t vebOffset(std::size_t v, int d) const {
+        const VebLevel & level = veb[d];
+        std::size_t subtree = v & level.mask;
+        return level.top_size + (subtree << level.bottom_height) - subtree;
+    }
+
+    /**
+     * Finds the nodes used by a query or an update of [l0, r0]. All of them
+     * are on the paths from the root to the leaves l0 and r0 or children
+     * of nodes on these paths. In the van Emde Boas layout, the positions
+     * on the two paths are computed once, top-down, and every other node
+     * is then found from the position of an ancestor in O(1).
+     */
+    class Locator {
+        const IntervalTree & tree;
+        std::size_t left_path[64];      // ancestors of l0 by depth
+        std::size_t path[2][64];
+
+    public:
+        Locator(const IntervalTree & t, std::size_t l0, std::size_t r0) : tree(t) {
+            if constexpr (Layout == TreeLayout::VanEmdeBoas) {
+                int h = t.levels - 1;
+                path[0][0] = path[1][0] = 0;
+                for (int d = 0; d <= h; ++d) {
+                    left_path[d] = l0 >> (h - d);
+                }
+                for (int d = 1; d <= h; ++d) {
+                    int top = t.veb[d].top_depth;
+                    path[0][d] = path[0][top] + t.vebOffset(left_path[d], d);
+                    path[1][d] = path[1][top] + t.vebOffset(r0 >> (h - d), d);
+                }
+            }
+        }
+
+        std::size_t operator()(std::size_t v) const {
+            if constexpr (Layout == TreeLayout::VanEmdeBoas) {
+                int d = depth(v);
+                if (d == 0) return 0;
+                int top = tree.veb[d].top_depth;
+                bool on_left = (v >> (d - top)) == left_path[top];
+                return path[on_left ? 0 : 1][top] + tree.vebOffset(v, d);
+            } else {
+                return v;
+            }
+        }
+    };
+
+    /**
+     * Apply the modifier of v to its children and make it the identity
+     */
+    void push(std::size_t v, const Locator & at) {
+        Node & n = T[at(v)];
+        Node & l = T[at(left(v))];
+        Node & r = T[at(right(v))];
+        l.mod = n * l;
+        r.mod = n * r;
+        n = { n.mod(n.val), {} };
+    }
+
+    /**
+     * Push the modifiers on the paths from the root, or from their ancestor
+     * at depth top, to the two leaves, level by level, visiting their common
+     * part once. In the compact layout the leaves may be at different depths.
+     */
+    void pushPaths(std::size_t l, std::size_t r, const Locator & at, int top = 0) {
+        int hl = depth(l), hr = depth(r);
+        for (int d = top; d < std::max(hl, hr); ++d) {
+            std::size_t a = d < hl ? l >> (hl - d) : 0;
+            std::size_t b = d < hr ? r >> (hr - d) : 0;
+            if (a > 0) push(a, at);
+            if (b > 0 && b != a) push(b, at);
+        }
+    }
+
+    /**
+     * Recompute the values on the paths from the two leaves to the root,
+     * or to their ancestor at depth top.
+     * The modifiers on the paths have been pushed, so only those of
+     * updated nodes are kept.
+     */
+    void pullPaths(std::size_t l, std::size_t r, const Locator & at, int top = 0) {
+        int hl = depth(l), hr = depth(r);
+        for (int d = std::max(hl, hr) - 1; d >= top; --d) {
+            std::size_t a = d < hl ? l >> (hl - d) : 0;
+            std::size_t b = d < hr ? r >> (hr - d) : 0;
+            if (a > 0) T[at(a)].val = T[at(left(a))] + T[at(right(a))];
+            if (b > 0 && b != a) T[at(b)].val = T[at(left(b))] + T[at(right(b))];
+        }
+    }
+
+    /**
+     * Run f(i) for every i in [begin, end), split into chunks between
+     * the threads if the range is long enough to pay for them
+     */
+    template <class F>
+    void parallelFor(std::size_t begin, std::size_t end, int threads, F f) const {
+        std::size_t count = end - begin;
+        std::size_t chunks = threads > 1 && count >= (std::size_t(1) << 14) ? 4 * static_cast<std::size_t>(threads) : 1;
+        runTasks(chunks, chunks > 1 ? threads : 1, [&](std::size_t c) {
+            for (std::size_t i = begin + count * c / chunks; i < begin + count * (c+1) / chunks; ++i) {
+                f(i);
+            }
+        });
+    }
+
+    /**
+     * Positions of the ancestors of v at depth d, and of v, by depth
+     */
+    void vebPath(std::size_t v, int d, std::size_t* path) const {
+        path[0] = 0;
+        for (int j = 1; j <= d; ++j) {
+            path[j] = path[veb[j].top_depth] + vebOffset(v >> (d - j), j);
+        }
+    }
+
+    /**
+     * Set the values to value(i) and compute the nodes. The leaves are set
+     * in parallel and the inner nodes level by level from the bottom, each
+     * level in parallel; in the van Emde Boas layout the subtrees below the
+     * top levels are built in parallel instead.
+     */
+    template <class Values>
+    void build(Values value, int threads) {
+        if constexpr (LeafSize > 1) {
+            elements.resize(N * LeafSize);
+            parallelFor(0, elements.size(), threads, [this, &value](std::size_t i) { elements[i] = value(i); });
+        }
+        auto leaf = [this, &value](std::size_t i) {
+            if constexpr (LeafSize > 1) {
+                return combineLeaf(i, 0, LeafSize);
+            } else {
+                return value(i);
+            }
+        };
+        if constexpr (Layout == TreeLayout::VanEmdeBoas) {
+            vebSplit(0, levels);
+            int k = threads > 1 && N >= (std::size_t(1) << 14) ? std::bit_width(4u * threads) : 0;
+            k = std::min(k, levels - 1);
+            runTasks(std::size_t(1) << k, k > 0 ? threads : 1, [this, k, &leaf](std::size_t i) {
+                std::size_t path[64];
+                vebPath((std::size_t(1) << k) + i, k, path);
+                buildVeb((std::size_t(1) << k) + i, k, path, leaf);
+            });
+            std::size_t path[64];
+            for (int d = k - 1; d >= 0; --d) {
+                for (std::size_t v = std::size_t(1) << d; v < std::size_t(2) << d; ++v) {
+                    vebPath(v, d, path);
+                    T[path[d]].val = T[position(left(v), d+1, path)] + T[position(right(v), d+1, path)];
+                }
+            }
+        } else {
+            parallelFor(0, N, threads, [this, &leaf](std::size_t i) { T[N+i].val = leaf(i); });
+            for (int d = levels - 1; d >= 0; --d) {
+                std::size_t from = std::size_t(1) << d, to = std::min(from << 1, N);
+                if (from >= to) continue;
+                parallelFor(from, to, threads, [this](std::size_t i) { T[i].val = T[left(i)] + T[right(i)]; });
+            }
+        }
+    }
+
+    /**
+     * Combine the values [from, to) of leaf i, from < to. Arithmetic values
+     * are summed in independent lanes, which the compiler maps to vector
+     * registers, and the lanes are added up at the end.
+     */
+    Value combineLeaf(std::size_t i, std::size_t from, std::size_t to) const {
+        const Value* x = elements.data() + i * LeafSize;
+        if constexpr (std::is_arithmetic_v<Value>) {
+            constexpr std::size_t lanes = 8;
+            Value res = Value();
+            std::size_t k = from;
+            if (to - from >= lanes) {
+                Value sum[lanes] = {};
+                for (; k + lanes <= to; k += lanes) {
+                    for (std::size_t j = 0; j < lanes; ++j) {
+                        sum[j] += x[k + j];
+                    }
+                }
+                for (std::size_t j = 0; j < lanes; ++j) {
+                    res += sum[j];
+                }
+            }
+            for (; k < to; ++k) {
+                res += x[k];
+            }
+            return res;
+        } else {
+            Value res = x[from];
+            for (std::size_t k = from + 1; k < to; ++k) {
+                res = res + x[k];
+            }
+            return res;
+        }
+    }
+
+    /**
+     * Push the modifier of the leaf v into its values, apply the modifier
+     * to the values [from, to) of the leaf and recompute it
+     */
+    void updateLeaf(std::size_t v, std::size_t from, std::size_t to, const Modifier & modifier, const Locator & at) {
+        Node & n = T[at(v)];
+        Value* x = elements.data() + (v - N) * LeafSize;
+        const Modifier pushed = n.mod;
+        for (std::size_t k = 0; k < LeafSize; ++k) {
+            x[k] = pushed(x[k]);
+        }
+        for (std::size_t k = from; k < to; ++k) {
+            x[k] = modifier(x[k]);
+        }
+        n = { combineLeaf(v - N, 0, LeafSize), {} };
+    }
+
+    /**
+     * Build the subtree of v at depth d in post-order; path[d] is the position
+     * of v, and the positions of its ancestors are above it
+     */
+    template <class Leaf>
+    void buildVeb(std::size_t v, int d, std::size_t* path, Leaf & leaf) {
+        if (d == levels - 1) {
+            T[path[d]].val = leaf(v - N);
+            return;
+        }
+        std::size_t child[2];
+        for (int c = 0; c < 2; ++c) {
+            std::size_t u = 2*v + c;
+            child[c] = path[veb[d+1].top_depth] + vebOffset(u, d+1);
+            path[d+1] = child[c];
+            buildVeb(u, d+1, path, leaf);
+        }
+        T[path[d]].val = T[child[0]] + T[child[1]];
+    }
+
+    /**
+     * Combine the values in [begin, end), which lie in the subtree of top,
+     * with the modifiers of the nodes up to top applied
+     */
+    Value queryBelow(std::size_t begin, std::size_t end, std::size_t top) const {
+        if (begin >= end) return {};
+        std::size_t first = begin / LeafSize, last = (end - 1) / LeafSize;
+        Locator at(*this, first + N, last + N);
+        Value res_left{}, res_right{};
+        bool has_left = false, has_right = false;
+        std::size_t l = first + N, r = last + 1 + N;
+        if constexpr (LeafSize > 1) {
+            // leaves covered in part start the partial results, without their modifiers
+            std::size_t from = begin - first * LeafSize, to = end - last * LeafSize;
+            if (first == last) {
+                if (from > 0 || to < LeafSize) {
+                    res_left = combineLeaf(first, from, to);
+                    has_left = true;
+                    l = r;
+                }
+            } else {
+                if (from > 0) {
+                    res_left = combineLeaf(first, from, LeafSize);
+                    has_left = true;
+                    ++l;
+                }
+                if (to < LeafSize) {
+                    res_right = combineLeaf(last, 0, to);
+                    has_right = true;
+                    --r;
+                }
+            }
+        }
+        for (; l < r; l >>= 1, r >>= 1) {
+            if (has_left) res_left = T[at(l-1)].mod(res_left);
+            if (has_right) res_right = T[at(r)].mod(res_right);
+            if (l & 1) {
+                const Node & n = T[at(l++)];
+                res_left = has_left ? res_left + n.mod(n.val) : n.mod(n.val);
+                has_left = true;
+            }
+            if (r & 1) {
+                const Node & n = T[at(--r)];
+                res_right = has_right ? n.mod(n.val) + res_right : n.mod(n.val);
+                has_right = true;
+            }
+        }
+        // l == r; walk both boundary paths up to their common ancestor
+        std::size_t a = l - 1, b = r;
+        if (has_left && has_right) {
+            for (; a != b; a >>= 1, b >>= 1) {
+                res_left = T[at(a)].mod(res_left);
+                res_right = T[at(b)].mod(res_right);
+            }
+            res_left = res_left + res_right;
+        } else if (has_right) {
+            res_left = res_right;
+            a = b;
+        }
+        for (; a >= top; a >>= 1) {
+            res_left = T[at(a)].mod(res_left);
+        }
+        return res_left;
+    }
+
+    /**
+     * Apply the modifier to the values in [begin, end), which lie in the
+     * subtree of top; the ancestors of top are not touched. If the range
+     * starts at the first leaf of the subtree, the parents of the updated
+     * nodes are all on the path to the last leaf of the range, and the path
+     * to the first one is skipped; the same holds for the other end.
+     */
+    void updateBelow(std::size_t begin, std::size_t end, const Modifier & modifier, std::size_t top,
+                     bool starts_subtree = false, bool ends_subtree = false) {
+        if (begin >= end) return;
+        std::size_t l0 = begin / LeafSize + N, r0 = (end - 1) / LeafSize + N;
+        Locator at(*this, l0, r0);
+        std::size_t a = starts_subtree ? r0 : l0, b = ends_subtree ? l0 : r0;
+        pushPaths(a, b, at, depth(top));
+        std::size_t l = l0, r = r0 + 1;
+        if constexpr (LeafSize > 1) {
+            std::size_t from = begin - (l0 - N) * LeafSize, to = end - (r0 - N) * LeafSize;
+            if (l0 == r0) {
+                if (from > 0 || to < LeafSize) {
+                    updateLeaf(l0, from, to, modifier, at);
+                    l = r;
+                }
+            } else {
+                if (from > 0) {
+                    updateLeaf(l0, from, LeafSize, modifier, at);
+                    ++l;
+                }
+                if (to < LeafSize) {
+                    updateLeaf(r0, 0, to, modifier, at);
+                    --r;
+                }
+            }
+        }
+        for (; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) {
+                Node & n = T[at(l++)];
+                n.mod = modifier * n.mod;
+            }
+            if (r & 1) {
+                Node & n = T[at(--r)];
+                n.mod = modifier * n.mod;
+            }
+        }
+        pullPaths(a, b, at, depth(top));
+    }
+
+    /**
+     * An update of a batch restricted to a subtree
+     */
+    struct Entry {
+        std::size_t begin, end;
+        Modifier modifier;
+    };
+
+    /**
+     * A subtree handed to a worker thread with the updates reaching it
+     */
+    struct Task {
+        std::size_t v;
+        int d;
+        std::size_t lo, hi;
+        std::array<std::size_t, 64> path;
+        std::vector<Entry> entries;
+    };
+
+    /**
+     * Number of leaves of a block, a subtree of about 256 KiB of nodes
+     * which stays in the cache while the operations of a batch inside
+     * it are applied one by one
+     */
+    static constexpr std::size_t block = std::max<std::size_t>((std::size_t(1) << 18) / (2 * sizeof(Node)), 1);
 
-        Node n1 = query(begin, end, l, (l+r)/2, left(v));
-        Node n2 = query(begin, end, (l+r)/2, r, right(v));
-        return {n1+n2, T[v].mod};
+    /**
+     * Position of the child u at depth d given the positions of its ancestors
+     */
+    std::size_t position(std::size_t u, int d, const std::size_t* path) const {
+        if constexpr (Layout == TreeLayout::VanEmdeBoas) {
+            return path[veb[d].top_depth] + vebOffset(u, d);
+        } else {
+            return u;
+        }
+    }
+
+    /**
+     * Disjoint subtrees covering all leaves as (node, lo, hi): the root, or
+     * the roots of the perfect trees of the compact layout, left to right;
+     * lo and hi are positions of values, not of leaves
+     */
+    std::vector<std::array<std::size_t, 3>> roots() const {
+        std::vector<std::array<std::size_t, 3>> result, right_side;
+        int k = 0;
+        for (std::size_t l = N, r = 2*N; l < r; l >>= 1, r >>= 1, ++k) {
+            if (l & 1) {
+                result.push_back({ l, ((l << k) - N) * LeafSize, (((l+1) << k) - N) * LeafSize });
+                ++l;
+            }
+            if (r & 1) {
+                --r;
+                right_side.push_back({ r, ((r << k) - N) * LeafSize, (((r+1) << k) - N) * LeafSize });
+            }
+        }
+        result.insert(result.end(), right_side.rbegin(), right_side.rend());
+        return result;
     }
 
-    void update(std::size_t begin, std::size_t end, Modifier modifier, std::size_t l, std::size_t r, int v) {
-        if (end <= l || r <= begin) return;
-        if (begin <= l && r <= end) {
-            T[v].mod = modifier * T[v].mod;
+    /**
+     * Distribute the updates of a node over [lo, hi) between its children,
+     * clipped to their ranges. Consecutive updates covering a child are
+     * composed into one.
+     */
+    static void split(const std::vector<Entry> & entries, std::size_t lo, std::size_t mid, std::size_t hi,
+                      std::vector<Entry> & left_entries, std::vector<Entry> & right_entries) {
+        left_entries.clear();
+        right_entries.clear();
+        auto add = [](std::vector<Entry> & list, const Entry & e, std::size_t from, std::size_t to) {
+            Entry clipped{ std::max(e.begin, from), std::min(e.end, to), e.modifier };
+            bool covers = clipped.begin == from && clipped.end == to;
+            if (covers && !list.empty() && list.back().begin == from && list.back().end == to) {
+                list.back().modifier = e.modifier * list.back().modifier;
+            } else {
+                list.push_back(clipped);
+            }
+        };
+        for (const Entry & e : entries) {
+            if (e.begin < mid) add(left_entries, e, lo, mid);
+            if (e.end > mid) add(right_entries, e, mid, hi);
+        }
+    }
+
+    /**
+     * Apply the updates to the subtree of v at depth d over [lo, hi), whose
+     * position is path[d]. The node takes the modifiers if all updates
+     * reaching it cover it. Otherwise, above the blocks, its modifier is
+     * pushed and the updates go down to the children in their order,
+     * and in a block or when only a few updates are left, they are applied
+     * one by one. If grain > 0, subtrees of at most grain values are
+     * collected as tasks instead, and the nodes above them are recorded
+     * with their children in visited to be recomputed afterwards.
+     */
+    void updateSubtree(std::size_t v, int d, std::size_t lo, std::size_t hi, std::size_t* path,
+                       const std::vector<Entry> & entries, std::vector<std::vector<Entry>> & lists,
+                       std::size_t grain, std::vector<Task>* tasks, std::vector<std::array<std::size_t, 3>>* visited) {
+        Node & n = T[path[d]];
+        if (std::all_of(entries.begin(), entries.end(),
+                        [lo, hi](const Entry & e) { return e.begin <= lo && e.end >= hi; })) {
+            for (const Entry & e : entries) {
+                n.mod = e.modifier * n.mod;
+            }
+            return;
+        }
+        if (hi - lo <= grain) {
+            tasks->push_back({ v, d, lo, hi, {}, entries });
+            std::copy(path, path + d + 1, tasks->back().path.begin());
+            return;
+        }
+        if (!grain && (entries.size() <= 4 || hi - lo <= block * LeafSize)) {
+            for (const Entry & e : entries) {
+                if (e.begin == lo && e.end == hi) {
+                    n.mod = e.modifier * n.mod;
+                } else {
+                    updateBelow(e.begin, e.end, e.modifier, v, e.begin == lo, e.end == hi);
+                }
+            }
             return;
         }
-        T[left(v)].mod = T[v] * T[left(v)];
-        T[right(v)].mod = T[v] * T[right(v)];
-        update(begin, end, modifier, l, (l+r)/2, left(v));
-        update(begin, end, modifier, (l+r)/2, r, right(v));
-        T[v] = { T[left(v)] + T[right(v)], {} };
+        std::size_t mid = lo + (hi - lo) / 2;
+        std::size_t child[2] = { position(left(v), d+1, path), position(right(v), d+1, path) };
+        Node & l = T[child[0]];
+        Node & r = T[child[1]];
+        l.mod = n * l;
+        r.mod = n * r;
+        n.mod = {};
+        std::vector<Entry> & left_entries = lists[2*d + 2];
+        std::vector<Entry> & right_entries = lists[2*d + 3];
+        split(entries, lo, mid, hi, left_entries, right_entries);
+        if (!left_entries.empty()) {
+            path[d+1] = child[0];
+            updateSubtree(left(v), d+1, lo, mid, path, left_entries, lists, grain, tasks, visited);
+        }
+        if (!right_entries.empty()) {
+            path[d+1] = child[1];
+            updateSubtree(right(v), d+1, mid, hi, path, right_entries, lists, grain, tasks, visited);
+        }
+        if (visited) {
+            visited->push_back({ path[d], child[0], child[1] });
+        } else {
+            n.val = T[child[0]] + T[child[1]];
+        }
+    }
+
+    /**
+     * Run job on every task using the given number of threads
+     */
+    template <class Job>
+    void runTasks(std::size_t tasks, int threads, Job job) const {
+        std::atomic<std::size_t> next{0};
+        auto worker = [&]() {
+            for (std::size_t i = next++; i < tasks; i = next++) {
+                job(i);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; ++t) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto & w : workers) {
+            w.join();
+        }
     }
 
 public:
     /**
      * Construct the tree initializing all values to value
-     * @param n         number of leaves, i.e. size of expected data
+     * @param n         number of values, i.e. size of expected data
      * @param value     the initial value for nodes
+     * @param threads   number of threads building the tree
      */
-    IntervalTree(std::size_t n, Value value = {}) : N(1 << (std::__lg(n) + 1)), T(2*N) {
-        Node node = {value, {}};
-        std::fill(T.begin() + N, T.end(), node);
-        for (int i = N-1; i > 0; i--) {
-            T[i].val = T[left(i)] + T[right(i)];
-        }
+    IntervalTree(std::size_t n, Value value = {}, int threads = 1)
+        : N(leaves(n)), levels(depth(N) + 1), T(2*N) {
+        build([&value](std::size_t) { return value; }, threads);
     }
 
     /**
      * Construct the tree initializing the nodes according to values
      * @param values     the initial values for nodes
+     * @param threads    number of threads building the tree
      */
-    IntervalTree(const std::vector<Value>& values) : N(1 << (std::__lg(values.size()) + 1)), T(2*N) {
-        for (int i = 0; i < values.size(); i++) {
-            T[N+i].val = values[i];
-        }
-        for (int i = N-1; i > 0; i--) {
-            T[i].val = T[left(i)] + T[right(i)];
-        }
+    IntervalTree(const std::vector<Value>& values, int threads = 1)
+        : N(leaves(values.size())), levels(depth(N) + 1), T(2*N) {
+        build([&values](std::size_t i) { return i < values.size() ? values[i] : Value(); }, threads);
+    }
+
+    /**
+     * @return      number of nodes allocated for the tree
+     */
+    std::size_t nodes() const {
+        return T.size();
     }
 
+    /**
+     * Combine the values in [begin, end) bottom-up. The nodes collected
+     * on the left side lie in the subtree of l-1 and those on the right
+     * side in the subtree of r, so the modifiers of the two boundary paths
+     * are applied to the partial results on the way up and nothing
+     * is pushed.
+     */
     Value query(std::size_t begin, std::size_t end) const {
-        if (begin == end) return {};
-        Node n = query(begin, end, 0, N, 1);
-        return n.mod(n.val);
+        return queryBelow(begin, end, 1);
     }
 
+    /**
+     * Apply the modifier to the values in [begin, end). The modifiers are
+     * pushed only along the paths to the two boundary leaves, which hold
+     * all the ancestors of the updated nodes, and these paths are
+     * recomputed afterwards.
+     */
     void update(std::size_t begin, std::size_t end, Modifier modifier) {
-        update(begin, end, modifier, 0, N, 1);
+        updateBelow(begin, end, modifier, 1);
+    }
+
+    /**
+     * Range update of a batch: apply modifier to the values in [begin, end)
+     */
+    struct RangeUpdate {
+        std::size_t begin, end;
+        Modifier modifier;
+    };
+
+    /**
+     * Apply the updates in their order. The updates are distributed top-down
+     * between the children down to blocks of nodes fitting in the cache, so
+     * the top levels are pushed and recomputed once per batch instead of once
+     * per update, and the updates inside a block are applied one by one
+     * while the block is cached. With threads > 1 the subtrees below the top
+     * levels are updated in parallel and the top levels recomputed afterwards.
+     * An update is split into pieces on every level it spans, so with one
+     * thread a batch whose ranges average more than a quarter of a block
+     * costs more than it saves and is applied one by one instead. A tree
+     * that fits in the last level cache gains little from batching either.
+     * @param updates   ranges with the modifiers to apply
+     * @param threads   number of threads to use
+     */
+    void update_batch(std::span<const RangeUpdate> updates, int threads = 1) {
+        if (threads <= 1) {
+            std::size_t total = 0;
+            for (const RangeUpdate & u : updates) {
+                if (u.begin < u.end) total += u.end - u.begin;
+            }
+            if (4 * total > updates.size() * block * LeafSize) {
+                for (const RangeUpdate & u : updates) {
+                    if (u.begin < u.end) update(u.begin, u.end, u.modifier);
+                }
+                return;
+            }
+        }
+        std::vector<Entry> entries, subtree;
+        entries.reserve(updates.size());
+        for (const RangeUpdate & u : updates) {
+            if (u.begin < u.end) entries.push_back({ u.begin, u.end, u.modifier });
+        }
+        std::vector<std::vector<Entry>> lists(2 * levels + 2);
+        std::size_t path[64] = {0};
+        std::size_t grain = threads > 1 ? std::max<std::size_t>(N / (4 * threads), block) * LeafSize : 0;
+        std::vector<Task> tasks;
+        std::vector<std::array<std::size_t, 3>> visited;
+        for (auto [v, lo, hi] : roots()) {
+            subtree.clear();
+            for (const Entry & e : entries) {
+                if (e.begin < hi && e.end > lo) subtree.push_back({ std::max(e.begin, lo), std::min(e.end, hi), e.modifier });
+            }
+            if (subtree.empty()) continue;
+            path[depth(v)] = Layout == TreeLayout::VanEmdeBoas ? 0 : v;
+            updateSubtree(v, depth(v), lo, hi, path, subtree, lists, grain,
+                          grain ? &tasks : nullptr, grain ? &visited : nullptr);
+        }
+        if (!grain) return;
+        runTasks(tasks.size(), threads, [this, &tasks](std::size_t i) {
+            Task & task = tasks[i];
+            std::vector<std::vector<Entry>> local(2 * levels + 2);
+            updateSubtree(task.v, task.d, task.lo, task.hi, task.path.data(), task.entries, local, 0, nullptr, nullptr);
+        });
+        // the nodes are recorded in post-order, children before parents
+        for (auto [at, l, r] : visited) {
+            T[at].val = T[l] + T[r];
+        }
+    }
+
+    /**
+     * Answer the queries, which do not change the tree, in the order of
+     * the blocks containing their beginnings. The ranges are copied in this
+     * order by a counting sort, so consecutive queries share most of their
+     * nodes in the cache. With threads > 1, every thread takes a run
+     * of consecutive blocks.
+     * @param ranges    ranges [begin, end) to combine
+     * @param out       the results, in the order of ranges
+     * @param threads   number of threads to use
+     */
+    void query_batch(std::span<const std::pair<std::size_t, std::size_t>> ranges, std::span<Value> out,
+                     int threads = 1) const {
+        auto bucket = [this](std::size_t begin) { return std::min(begin / LeafSize, N - 1) / block; };
+        std::vector<std::size_t> start((N + block - 1) / block + 1, 0);
+        for (const auto & [begin, end] : ranges) {
+            if (begin < end) ++start[bucket(begin) + 1];
+        }
+        for (std::size_t b = 1; b < start.size(); ++b) {
+            start[b] += start[b-1];
+        }
+        std::vector<std::array<std::size_t, 3>> sorted(start.back());
+        for (std::size_t i = 0; i < ranges.size(); ++i) {
+            if (ranges[i].first < ranges[i].second) {
+                sorted[start[bucket(ranges[i].first)]++] = { ranges[i].first, ranges[i].second, i };
+            } else {
+                out[i] = Value();
+            }
+        }
+        std::size_t chunks = std::max(threads, 1);
+        runTasks(chunks, threads, [&](std::size_t c) {
+            for (std::size_t k = sorted.size() * c / chunks; k < sorted.size() * (c+1) / chunks; ++k) {
+                out[sorted[k][2]] = query(sorted[k][0], sorted[k][1]);
+            }
+        });
     }
 };
 
@@ -0,0 +1,268 @@
+#include "interval_tree.hpp"
+#include "persistent_interval_tree.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * Sum of 32-bit values modulo 2^32
+ */
+struct Sum {
+    std::uint32_t val = 0;
+    Sum operator+(const Sum & other) const {
+        return {val + other.val};
+    }
+};
+
+/**
+ * Multiplication of all values in a range
+ */
+struct Multiply {
+    std::uint32_t mod = 1;
+    Multiply operator*(const Multiply & other) const {
+        return {mod * other.mod};
+    }
+    Sum operator()(const Sum & v) const {
+        return {v.val * mod};
+    }
+};
+
+/**
+ * Multiplication of plain 32-bit values, which the tree sums with built-in +
+ */
+struct Scale {
+    std::uint32_t c = 1;
+    Scale operator*(const Scale & other) const {
+        return {c * other.c};
+    }
+    std::uint32_t operator()(std::uint32_t v) const {
+        return c * v;
+    }
+};
+
+/**
+ * Memory, build time and latency of point updates, range updates
+ * and range queries at random positions
+ */
+template <TreeLayout Layout>
+void bench(const std::string & name, std::size_t n, int operations) {
+    auto start = Clock::now();
+    IntervalTree<Sum, Multiply, Layout> tree(n, Sum{1});
+    double build_ms = elapsed_ms(start);
+    std::mt19937_64 gen(2024);
+    std::vector<std::size_t> positions(2 * operations);
+    for (auto & p : positions) {
+        p = gen() % n;
+    }
+    std::uint32_t checksum = 0;
+
+    start = Clock::now();
+    for (int i = 0; i < operations; i++) {
+        std::size_t p = positions[i];
+        tree.update(p, p + 1, Multiply{3});
+    }
+    double point_ns = elapsed_ms(start) * 1e6 / operations;
+
+    start = Clock::now();
+    for (int i = 0; i < operations; i++) {
+        std::size_t a = positions[2*i], b = positions[2*i + 1];
+        tree.update(std::min(a, b), std::max(a, b) + 1, Multiply{5});
+    }
+    double range_update_ns = elapsed_ms(start) * 1e6 / operations;
+
+    start = Clock::now();
+    for (int i = 0; i < operations; i++) {
+        std::size_t a = positions[2*i], b = positions[2*i + 1];
+        checksum += tree.query(std::min(a, b), std::max(a, b) + 1).val;
+    }
+    double query_ns = elapsed_ms(start) * 1e6 / operations;
+
+    double memory_mb = static_cast<double>(tree.nodes() * (sizeof(Sum) + sizeof(Multiply))) / (1 << 20);
+    std::cout << "  " << name << ": " << tree.nodes() << " nodes (" << memory_mb << " MB), build "
+              << build_ms << " ms, point update " << point_ns << " ns, range update " << range_update_ns
+              << " ns, range query " << query_ns << " ns (checksum " << checksum % 1000 << ")" << std::endl;
+}
+
+/**
+ * Build time with the given number of threads
+ */
+template <TreeLayout Layout>
+void bench_build(const std::string & name, std::size_t n, int threads) {
+    auto start = Clock::now();
+    IntervalTree<Sum, Multiply, Layout> tree(n, Sum{1}, threads);
+    double build_ms = elapsed_ms(start);
+    std::cout << "  " << name << ", " << threads << " threads: build " << build_ms << " ms, "
+              << tree.nodes() << " nodes" << std::endl;
+}
+
+/**
+ * Memory, build time and latency of a tree of arithmetic values stored
+ * LeafSize per leaf, whose partial leaves are summed in vector registers
+ */
+template <std::size_t LeafSize>
+void bench_leaves(std::size_t n, int operations) {
+    auto start = Clock::now();
+    IntervalTree<std::uint32_t, Scale, TreeLayout::Perfect, LeafSize> tree(n, 1);
+    double build_ms = elapsed_ms(start);
+    std::mt19937_64 gen(2024);
+    std::vector<std::size_t> positions(2 * operations);
+    for (auto & p : positions) {
+        p = gen() % n;
+    }
+    std::uint32_t checksum = 0;
+
+    start = Clock::now();
+    for (int i = 0; i < operations; i++) {
+        std::size_t a = positions[2*i], b = positions[2*i + 1];
+        tree.update(std::min(a, b), std::max(a, b) + 1, Scale{5});
+    }
+    double update_ns = elapsed_ms(start) * 1e6 / operations;
+
+    start = Clock::now();
+    for (int i = 0; i < operations; i++) {
+        std::size_t a = positions[2*i], b = positions[2*i + 1];
+        checksum += tree.query(std::min(a, b), std::max(a, b) + 1);
+    }
+    double query_ns = elapsed_ms(start) * 1e6 / operations;
+
+    double memory_mb = static_cast<double>(tree.nodes() * 2 * sizeof(std::uint32_t) + n * sizeof(std::uint32_t))
+                       / (1 << 20);
+    std::cout << "  " << LeafSize << " per leaf: " << tree.nodes() << " nodes (" << memory_mb << " MB with the values), build "
+              << build_ms << " ms, range update " << update_ns << " ns, range query " << query_ns
+              << " ns (checksum " << checksum % 1000 << ")" << std::endl;
+}
+
+/**
+ * Memory and latency of a persistent tree keeping a version per update,
+ * compared with a copy of the ephemeral tree per version
+ */
+void bench_persistent(std::size_t n, int operations) {
+    auto start = Clock::now();
+    PersistentIntervalTree<Sum, Multiply> tree(n, Sum{1});
+    double build_ms = elapsed_ms(start);
+    std::size_t initial = tree.nodes();
+    std::mt19937_64 gen(2024);
+    start = Clock::now();
+    for (int i = 0; i < operations; i++) {
+        std::size_t a = gen() % n, b = gen() % n;
+        tree.update(tree.versions() - 1, std::min(a, b), std::max(a, b) + 1, Multiply{3});
+    }
+    double update_ns = elapsed_ms(start) * 1e6 / operations;
+    std::uint32_t checksum = 0;
+    start = Clock::now();
+    for (int i = 0; i < operations; i++) {
+        std::size_t a = gen() % n, b = gen() % n;
+        checksum += tree.query(gen() % tree.versions(), std::min(a, b), std::max(a, b) + 1).val;
+    }
+    double query_ns = elapsed_ms(start) * 1e6 / operations;
+    double node_mb = static_cast<double>(sizeof(Sum) + sizeof(Multiply) + 8) / (1 << 20);
+    std::cout << "  Persistent: build " << build_ms << " ms, " << operations << " versions in " << tree.nodes()
+              << " nodes (" << static_cast<double>(tree.nodes() - initial) / operations << " per update, "
+              << static_cast<double>(tree.nodes()) * node_mb << " MB instead of "
+              << static_cast<double>(initial) * node_mb * operations / 1024 << " GB of copies), update " << update_ns
+              << " ns, query of a random version " << query_ns << " ns (checksum " << checksum % 1000 << ")"
+              << std::endl;
+}
+
+/**
+ * Rounds of `batch` range updates followed by `batch` range queries of up to
+ * `length` leaves, applied one by one or as batches with the given number
+ * of threads; compact trees, so that two of them fit in memory
+ */
+void bench_batch(std::size_t n, std::size_t batch, std::size_t length, int rounds, int threads) {
+    using Tree = IntervalTree<Sum, Multiply, TreeLayout::Compact>;
+    Tree single(n, Sum{1}), batched(n, Sum{1});
+    std::mt19937_64 gen(2024);
+    std::vector<Tree::RangeUpdate> updates(batch);
+    std::vector<std::pair<std::size_t, std::size_t>> ranges(batch);
+    std::vector<Sum> results(batch);
+    auto random_range = [&gen, n, length]() {
+        std::size_t begin = gen() % n;
+        return std::make_pair(begin, std::min(n, begin + 1 + gen() % length));
+    };
+    std::uint32_t single_checksum = 0, batch_checksum = 0;
+    double single_update = 0, single_query = 0, batch_update = 0, batch_query = 0;
+    for (int round = 0; round < rounds; round++) {
+        for (std::size_t i = 0; i < batch; i++) {
+            auto [begin, end] = random_range();
+            updates[i] = {begin, end, Multiply{static_cast<std::uint32_t>(2 * (gen() % 4) + 1)}};
+            ranges[i] = random_range();
+        }
+        auto start = Clock::now();
+        for (const auto & u : updates) {
+            single.update(u.begin, u.end, u.modifier);
+        }
+        single_update += elapsed_ms(start);
+        start = Clock::now();
+        for (const auto & [begin, end] : ranges) {
+            single_checksum += single.query(begin, end).val;
+        }
+        single_query += elapsed_ms(start);
+
+        start = Clock::now();
+        batched.update_batch(updates, threads);
+        batch_update += elapsed_ms(start);
+        start = Clock::now();
+        batched.query_batch(ranges, results, threads);
+        batch_query += elapsed_ms(start);
+        for (const Sum & res : results) {
+            batch_checksum += res.val;
+        }
+    }
+    double ns = 1e6 / static_cast<double>(batch * rounds);
+    std::cout << "  batches of " << batch << ", length up to " << length << ", " << threads << " threads: update "
+              << single_update * ns << " -> " << batch_update * ns << " ns, query " << single_query * ns << " -> "
+              << batch_query * ns << " ns (checksums " << single_checksum % 1000 << ", " << batch_checksum % 1000
+              << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {1000000, 100000000};
+    }
+    int operations = 1000000;
+    for (std::size_t n : sizes) {
+        std::cout << n << " leaves" << std::endl;
+        bench<TreeLayout::Perfect>("Perfect", n, operations);
+        bench<TreeLayout::Compact>("Compact", n, operations);
+        bench<TreeLayout::VanEmdeBoas>("VanEmdeBoas", n, operations);
+        if (n <= 30000000) {
+            // 10^8 leaves and 10^6 versions take about 5 GB
+            bench_persistent(n, operations);
+        }
+        int threads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+        std::cout << " construction" << std::endl;
+        for (int t : {1, threads}) {
+            bench_build<TreeLayout::Perfect>("Perfect", n, t);
+            bench_build<TreeLayout::VanEmdeBoas>("VanEmdeBoas", n, t);
+        }
+        std::cout << " plain 32-bit sums by leaf size" << std::endl;
+        bench_leaves<1>(n, operations);
+        bench_leaves<8>(n, operations);
+        bench_leaves<16>(n, operations);
+        std::cout << " one by one -> batched" << std::endl;
+        for (std::size_t length : {n, std::size_t(100)}) {
+            bench_batch(n, operations, length, 1, 1);
+            bench_batch(n, operations, length, 1, threads);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,385 @@
+/**
+ * Allocators for node based containers (UnorderedMap, DoubleList) and
+ * for Heap. Memory is taken from slabs of SLAB_SIZE bytes which are cached
+ * per thread, so building and tearing down containers in a loop reuses
+ * the same slabs instead of calling the global allocator for every node.
+ *
+ * MonotonicArena hands out memory by bumping a pointer and never reuses
+ * freed blocks; PoolResource keeps a free list for each size class
+ * (multiples of 16 bytes up to 512) so erased nodes are reused.
+ * Both return all their slabs at once on release().
+ *
+ * ArenaAllocator and PoolAllocator are standard allocators over these
+ * resources. A default constructed allocator owns a fresh resource which
+ * is shared by its copies, and a container holding the only copy may
+ * clear itself by releasing the whole resource (see memory::ownsResource).
+ * Resources are not thread-safe: a resource must be used by one thread
+ * at a time, although the slabs may be freed by another thread.
+ * AlignedAllocator aligns arrays to cache lines.
+ */
+
+#ifndef ALGORITHMS_MEMORY_POOL_HPP
+#define ALGORITHMS_MEMORY_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace memory {
+
+constexpr std::size_t SLAB_SIZE = 64 * 1024;
+
+/**
+ * Per thread cache of free slabs
+ */
+class SlabCache {
+    static constexpr std::size_t MAX_CACHED = 256;
+    std::vector<void*> slabs;
+
+public:
+    SlabCache() = default;
+    SlabCache(const SlabCache &) = delete;
+    SlabCache& operator=(const SlabCache &) = delete;
+    ~SlabCache() {
+        for (void* slab : slabs) {
+            ::operator delete(slab);
+        }
+    }
+
+    static SlabCache& local() {
+        thread_local SlabCache cache;
+        return cache;
+    }
+
+    void* acquire() {
+        if (slabs.empty()) {
+            return ::operator new(SLAB_SIZE);
+        }
+        void* slab = slabs.back();
+        slabs.pop_back();
+        return slab;
+    }
+
+    void recycle(void* slab) {
+        if (slabs.size() < MAX_CACHED) {
+            slabs.push_back(slab);
+        } else {
+            ::operator delete(slab);
+        }
+    }
+};
+
+inline char* alignUp(char* p, std::size_t align) {
+    auto address = reinterpret_cast<std::uintptr_t>(p);
+    return p + ((align - address % align) % align);
+}
+
+} // namespace memory
+
+/**
+ * Bump allocator over slabs. Deallocation does nothing,
+ * the memory is reclaimed by release() or by the destructor.
+ */
+class MonotonicArena {
+    std::vector<void*> slabs;
+    std::vector<std::pair<void*, std::size_t>> large;
+    char* cur = nullptr;
+    char* last = nullptr;
+
+public:
+    MonotonicArena() = default;
+    MonotonicArena(const MonotonicArena &) = delete;
+    MonotonicArena& operator=(const MonotonicArena &) = delete;
+    ~MonotonicArena() {
+        release();
+    }
+
+    /**
+     * Allocate memory for bytes of given alignment. Requests larger than
+     * a quarter of a slab get their own block.
+     * @param bytes
+     * @param align     power of two
+     * @return          pointer to the memory
+     */
+    void* allocate(std::size_t bytes, std::size_t align) {
+        if (bytes + align > memory::SLAB_SIZE / 4) {
+            void* p = ::operator new(bytes, std::align_val_t(align));
+            large.emplace_back(p, align);
+            return p;
+        }
+        char* p = memory::alignUp(cur, align);
+        if (cur == nullptr || p + bytes > last) {
+            cur = static_cast<char*>(memory::SlabCache::local().acquire());
+            last = cur + memory::SLAB_SIZE;
+            slabs.push_back(cur);
+            p = memory::alignUp(cur, align);
+        }
+        cur = p + bytes;
+        return p;
+    }
+
+    void deallocate(void*, std::size_t, std::size_t) { }
+
+    /**
+     * Free all memory allocated from the arena
+     */
+    void release() {
+        for (void* slab : slabs) {
+            memory::SlabCache::local().recycle(slab);
+        }
+        for (auto [p, align] : large) {
+            ::operator delete(p, std::align_val_t(align));
+        }
+        slabs.clear();
+        large.clear();
+        cur = last = nullptr;
+    }
+};
+
+/**
+ * Pool of blocks of size classes. Freed blocks go to the free list
+ * of their class and are handed out again before the slab is bumped.
+ */
+class PoolResource {
+    static constexpr std::size_t GRANULE = 16;
+    static constexpr std::size_t CLASSES = 32;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct LargeBlock {
+        LargeBlock* prev;
+        LargeBlock* next;
+        std::size_t header;
+    };
+
+    FreeBlock* free_lists[CLASSES] = { };
+    std::vector<void*> slabs;
+    LargeBlock large = {&large, &large, 0};
+    char* cur = nullptr;
+    char* last = nullptr;
+
+    void* allocateLarge(std::size_t bytes, std::size_t align) {
+        std::size_t header = align > 2 * GRANULE ? align : 2 * GRANULE;
+        char* raw = static_cast<char*>(::operator new(header + bytes, std::align_val_t(header)));
+        auto* block = reinterpret_cast<LargeBlock*>(raw + header - sizeof(LargeBlock));
+        block->header = header;
+        block->prev = &large;
+        block->next = large.next;
+        large.next->prev = block;
+        large.next = block;
+        return raw + header;
+    }
+
+    static void freeLarge(LargeBlock* block) {
+        char* raw = reinterpret_cast<char*>(block + 1) - block->header;
+        ::operator delete(raw, std::align_val_t(block->header));
+    }
+
+    static void deallocateLarge(void* p) {
+        auto* block = reinterpret_cast<LargeBlock*>(p) - 1;
+        block->prev->next = block->next;
+        block->next->prev = block->prev;
+        freeLarge(block);
+    }
+
+    static bool isLarge(std::size_t bytes, std::size_t align) {
+        return bytes > GRANULE * CLASSES || align > GRANULE;
+    }
+
+public:
+    PoolResource() = default;
+    PoolResource(const PoolResource &) = delete;
+    PoolResource& operator=(const PoolResource &) = delete;
+    ~PoolResource() {
+        release();
+    }
+
+    /**
+     * Allocate memory for bytes of given alignment. Blocks over 512 bytes
+     * or aligned to more than 16 bytes are taken from the global allocator.
+     * @param bytes
+     * @param align     power of two
+     * @return          pointer to the memory
+     */
+    void* allocate(std::size_t bytes, std::size_t align) {
+        if (isLarge(bytes, align)) {
+            return allocateLarge(bytes, align);
+        }
+        std::size_t c = bytes == 0 ? 0 : (bytes - 1) / GRANULE;
+        if (free_lists[c] != nullptr) {
+            FreeBlock* block = free_lists[c];
+            free_lists[c] = block->next;
+            return block;
+        }
+        std::size_t size = (c + 1) * GRANULE;
+        if (static_cast<std::size_t>(last - cur) < size) {
+            cur = static_cast<char*>(memory::SlabCache::local().acquire());
+            last = cur + memory::SLAB_SIZE;
+            slabs.push_back(cur);
+        }
+        void* p = cur;
+        cur += size;
+        return p;
+    }
+
+    void deallocate(void* p, std::size_t bytes, std::size_t align) {
+        if (isLarge(bytes, align)) {
+            deallocateLarge(p);
+            return;
+        }
+        std::size_t c = bytes == 0 ? 0 : (bytes - 1) / GRANULE;
+        auto* block = static_cast<FreeBlock*>(p);
+        block->next = free_lists[c];
+        free_lists[c] = block;
+    }
+
+    /**
+     * Free all memory allocated from the pool
+     */
+    void release() {
+        for (void* slab : slabs) {
+            memory::SlabCache::local().recycle(slab);
+        }
+        while (large.next != &large) {
+            LargeBlock* block = large.next;
+            large.next = block->next;
+            freeLarge(block);
+        }
+        slabs.clear();
+        std::fill_n(free_lists, CLASSES, nullptr);
+        large.prev = &large;
+        cur = last = nullptr;
+    }
+};
+
+/**
+ * Standard allocator over a MonotonicArena or a PoolResource
+ */
+template <class T, class Resource>
+class ResourceAllocator {
+    template <class, class> friend class ResourceAllocator;
+    std::shared_ptr<Resource> resource;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ResourceAllocator() : resource(std::make_shared<Resource>()) { }
+    /**
+     * Allocate from a resource owned by the caller, which has to outlive
+     * the allocator and all its copies. Containers never release it.
+     * @param shared
+     */
+    explicit ResourceAllocator(Resource & shared) : resource(std::shared_ptr<Resource>(), &shared) { }
+    template <class U>
+    ResourceAllocator(const ResourceAllocator<U, Resource> & other) : resource(other.resource) { }
+
+    T* allocate(std::size_t n) {
+        if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        resource->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    /**
+     * Copies of a container get a fresh resource instead of sharing it
+     */
+    ResourceAllocator select_on_container_copy_construction() const {
+        return ResourceAllocator();
+    }
+
+    /**
+     * @return      true if no other allocator uses the resource
+     */
+    bool exclusive() const {
+        return resource.use_count() == 1;
+    }
+
+    void release() {
+        resource->release();
+    }
+
+    friend bool operator==(const ResourceAllocator & a, const ResourceAllocator & b) {
+        return a.resource == b.resource;
+    }
+};
+
+/**
+ * Standard allocator returning memory aligned to Align bytes,
+ * e.g. to the size of a cache line
+ */
+template <class T, std::size_t Align>
+class AlignedAllocator {
+public:
+    static_assert(Align >= alignof(T) && (Align & (Align - 1)) == 0);
+    using value_type = T;
+    template <class U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align>;
+    };
+
+    AlignedAllocator() = default;
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U, Align> &) { }
+
+    T* allocate(std::size_t n) {
+        if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    friend bool operator==(const AlignedAllocator &, const AlignedAllocator &) {
+        return true;
+    }
+};
+
+template <class T>
+using ArenaAllocator = ResourceAllocator<T, MonotonicArena>;
+
+template <class T>
+using PoolAllocator = ResourceAllocator<T, PoolResource>;
+
+namespace memory {
+
+/**
+ * Check if the container holding alloc may free all its nodes at once
+ * by releasing the resource instead of deallocating them one by one
+ * @param alloc
+ * @return          true if alloc is the only user of its resource
+ */
+template <class Alloc>
+bool ownsResource(const Alloc & alloc) {
+    if constexpr (requires { alloc.exclusive(); }) {
+        return alloc.exclusive();
+    } else {
+        return false;
+    }
+}
+
+template <class Alloc>
+void release(Alloc & alloc) {
+    if constexpr (requires { alloc.release(); }) {
+        alloc.release();
+    }
+}
+
+} // namespace memory
+
+#endif //ALGORITHMS_MEMORY_POOL_HPP
@@ -0,0 +1,145 @@
+#include "unordered_map.hpp"
+#include "heap.hpp"
+#include "double_linked_list.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * std::string which counts how many times it was copied
+ */
+struct CountedString {
+    static inline std::size_t copies = 0;
+    std::string s;
+
+    CountedString() = default;
+    explicit CountedString(std::string _s) : s(std::move(_s)) { }
+    CountedString(const CountedString & other) : s(other.s) { ++copies; }
+    CountedString(CountedString && other) noexcept = default;
+    CountedString& operator=(const CountedString & other) {
+        s = other.s;
+        ++copies;
+        return *this;
+    }
+    CountedString& operator=(CountedString && other) noexcept = default;
+
+    friend bool operator==(const CountedString & a, const CountedString & b) { return a.s == b.s; }
+    friend bool operator<(const CountedString & a, const CountedString & b) { return a.s < b.s; }
+};
+
+template <class Hash>
+struct CountedHash {
+    Hash hash;
+    explicit CountedHash(std::uint64_t seed = 0) : hash(seed) { }
+    std::uint64_t operator()(const CountedString & key) const {
+        return hash(key.s);
+    }
+};
+
+using Map = UnorderedMap<CountedString, CountedString,
+                         CountedHash<WyHash<std::string>>, CountedHash<WyHash<std::string>>>;
+
+/**
+ * Strings longer than the small string buffer, so every copy allocates
+ */
+std::vector<CountedString> make_strings(int n) {
+    std::vector<CountedString> strings;
+    strings.reserve(n);
+    for (int i = 0; i < n; i++) {
+        strings.emplace_back("a rather long key that does not fit in SSO #" + std::to_string(i));
+    }
+    return strings;
+}
+
+template <class F>
+void run(const std::string & name, int n, F f) {
+    auto strings = make_strings(n);
+    CountedString::copies = 0;
+    auto start = Clock::now();
+    f(strings);
+    double ms = elapsed_ms(start);
+    std::cout << "  " << name << ": " << CountedString::copies << " copies, " << ms << " ms" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    std::cout << "UnorderedMap, " << n << " string keys (with rehashes)" << std::endl;
+    run("insert(const pair &)", n, [](std::vector<CountedString> & strings) {
+        Map map;
+        for (auto & s : strings) {
+            std::pair<CountedString, CountedString> p(std::move(s), CountedString("value"));
+            map.insert(p);
+        }
+    });
+    run("insert(pair &&)", n, [](std::vector<CountedString> & strings) {
+        Map map;
+        for (auto & s : strings) {
+            map.insert(std::pair<CountedString, CountedString>(std::move(s), CountedString("value")));
+        }
+    });
+    run("try_emplace(Key &&)", n, [](std::vector<CountedString> & strings) {
+        Map map;
+        for (auto & s : strings) {
+            map.try_emplace(std::move(s), "value");
+        }
+    });
+    run("operator[](const Key &)", n, [](std::vector<CountedString> & strings) {
+        Map map;
+        for (auto & s : strings) {
+            map[s].s = "value";
+        }
+    });
+    run("move constructed map", n, [](std::vector<CountedString> & strings) {
+        Map map;
+        for (auto & s : strings) {
+            map.try_emplace(std::move(s), "value");
+        }
+        Map moved(std::move(map));
+    });
+
+    std::cout << "Heap, " << n << " strings pushed and popped" << std::endl;
+    run("insert(const T &)", n, [](std::vector<CountedString> & strings) {
+        Heap<CountedString> heap;
+        for (auto & s : strings) {
+            heap.insert(s);
+        }
+        while (heap.size() > 0) {
+            heap.pop();
+        }
+    });
+    run("insert(T &&)", n, [](std::vector<CountedString> & strings) {
+        Heap<CountedString> heap;
+        for (auto & s : strings) {
+            heap.insert(std::move(s));
+        }
+        while (heap.size() > 0) {
+            heap.pop();
+        }
+    });
+
+    std::cout << "DoubleList, " << n << " strings" << std::endl;
+    run("push_back(const T &)", n, [](std::vector<CountedString> & strings) {
+        DoubleList<CountedString> list;
+        for (auto & s : strings) {
+            list.push_back(s);
+        }
+    });
+    run("push_back(T &&)", n, [](std::vector<CountedString> & strings) {
+        DoubleList<CountedString> list;
+        for (auto & s : strings) {
+            list.push_back(std::move(s));
+        }
+    });
+    return 0;
+}
@@ -0,0 +1,144 @@
+/**
+ * Unbounded lock-free intrusive queue for many producer threads and one
+ * consumer thread (Vyukov's MPSC queue). It links the same Node<T> as
+ * DoubleList and has the same create, destroy, push_back, pop_front and
+ * empty operations, so a DoubleList used as a work queue under a mutex
+ * can be replaced by changing its type. A producer links its node with
+ * a single atomic exchange on the back of the queue and never waits;
+ * nodes are chained through next[0] only, accessed with std::atomic_ref.
+ * pop_front and empty are called by the consumer only. Nodes are
+ * allocated with Allocator rebound to Node<T> from every producer, so the
+ * allocator has to be thread-safe (PoolAllocator is not).
+ */
+
+#ifndef ALGORITHMS_MPSC_QUEUE_HPP
+#define ALGORITHMS_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include "double_linked_list.hpp"
+
+template <class T, class Allocator = std::allocator<T>>
+class MpscQueue {
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node<T>>;
+    using Traits = std::allocator_traits<NodeAllocator>;
+    NodeAllocator node_alloc;
+
+    alignas(64) std::atomic<Node<T>*> back;     // last linked node, exchanged by producers
+    alignas(64) Node<T>* front;                 // oldest node, owned by the consumer
+    Node<T> stub;                               // placeholder linked in when the queue runs empty
+
+    static std::atomic_ref<Node<T>*> link(Node<T>* node) {
+        return std::atomic_ref<Node<T>*>(node->next[0]);
+    }
+
+public:
+    explicit MpscQueue(const Allocator & alloc = Allocator()) : node_alloc(alloc), back(&stub), front(&stub) {
+        stub.next[0] = nullptr;
+    }
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue& operator=(const MpscQueue &) = delete;
+    ~MpscQueue() {
+        while (Node<T>* node = pop_front()) {
+            destroy(node);
+        }
+    }
+
+    /**
+     * If a producer is still in push_back, its node may not be visible yet
+     */
+    bool empty() {
+        return front == &stub && link(&stub).load(std::memory_order_acquire) == nullptr;
+    }
+
+    /**
+     * Allocate a node that can be added to the queue
+     * @param args      arguments of the T constructor
+     * @return          pointer to the new node
+     */
+    template <class... Args>
+    Node<T>* create(Args&&... args) {
+        Node<T>* node = Traits::allocate(node_alloc, 1);
+        try {
+            Traits::construct(node_alloc, node, std::in_place, std::forward<Args>(args)...);
+        } catch (...) {
+            Traits::deallocate(node_alloc, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    /**
+     * Free a node removed from the queue by pop_front
+     * @param node
+     */
+    void destroy(Node<T>* node) {
+        Traits::destroy(node_alloc, node);
+        Traits::deallocate(node_alloc, node, 1);
+    }
+
+    /**
+     * Add node initialized with name to the end of the queue
+     * @param name
+     */
+    void push_back(const T & name) {
+        push_back(create(name));
+    }
+
+    void push_back(T && name) {
+        push_back(create(std::move(name)));
+    }
+
+    /**
+     * Add node with element constructed from args to the end of the queue
+     * @param args      arguments of the T constructor
+     */
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        push_back(create(std::forward<Args>(args)...));
+    }
+
+    /**
+     * Add node to the end of the queue. Between the exchange and the store
+     * the node is not reachable from the front yet, so the consumer sees
+     * the queue as ending before it.
+     * The node has to be allocated by create()
+     * @param node
+     */
+    void push_back(Node<T>* node) {
+        link(node).store(nullptr, std::memory_order_relaxed);
+        Node<T>* prev = back.exchange(node, std::memory_order_acq_rel);
+        link(prev).store(node, std::memory_order_release);
+    }
+
+    /**
+     * Remove the first element from the queue.
+     * If queue is empty, return nullptr;
+     * The node should be freed by destroy()
+     * @return      pointer to the removed node
+     */
+    Node<T> * pop_front() {
+        Node<T>* node = front;
+        Node<T>* next = link(node).load(std::memory_order_acquire);
+        if (node == &stub) {
+            if (next == nullptr) return nullptr;
+            front = node = next;
+            next = link(node).load(std::memory_order_acquire);
+        }
+        if (next == nullptr) {
+            // node is the last one linked, or a producer is in between
+            // its exchange and store; the stub goes behind it either way
+            if (node != back.load(std::memory_order_acquire)) return nullptr;
+            push_back(&stub);
+            next = link(node).load(std::memory_order_acquire);
+            if (next == nullptr) return nullptr;
+        }
+        front = next;
+        node->next[0] = nullptr;
+        node->next[1] = nullptr;
+        return node;
+    }
+};
+
+#endif //ALGORITHMS_MPSC_QUEUE_HPP
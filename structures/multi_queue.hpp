@@ -0,0 +1,204 @@
+/**
+ * Relaxed concurrent priority queue (MultiQueue) built from c*p instances
+ * of Heap for p threads, each guarded by its own try-lock. Insertion puts
+ * the element into a random sub-heap, and pop takes the better of the tops
+ * of two randomly sampled sub-heaps. Threads never wait for a lock: when
+ * a try-lock fails, other sub-heaps are sampled instead, so throughput
+ * scales with the number of threads.
+ *
+ * The price is that pop does not always return the top of the whole queue:
+ * the popped element is expected to be among the O(c*p) best ones.
+ * With the default comparator, larger elements are popped first as in Heap.
+ */
+
+#ifndef ALGORITHMS_MULTI_QUEUE_HPP
+#define ALGORITHMS_MULTI_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "heap.hpp"
+
+template<typename T, typename Compare = std::less<T>>
+class MultiQueue {
+    struct alignas(64) Queue {
+        std::atomic<bool> locked{false};
+        std::atomic<int> size{0};       // written under the lock, read without it
+        Heap<T, Compare> heap;
+
+        explicit Queue(Compare comp) : heap(8, comp) { }
+
+        bool try_lock() {
+            return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+        }
+        void lock() {
+            while (!try_lock()) {
+                std::this_thread::yield();
+            }
+        }
+        void unlock() {
+            size.store(heap.size(), std::memory_order_relaxed);
+            locked.store(false, std::memory_order_release);
+        }
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    int queue_count;
+    Compare compare;
+
+    /**
+     * xorshift generator of the calling thread, seeded by the thread id
+     */
+    static std::uint64_t random() {
+        thread_local std::uint64_t state =
+                std::hash<std::thread::id>()(std::this_thread::get_id()) * 0x9E3779B97F4A7C15ULL | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    int randomQueue() const {
+        return static_cast<int>((random() >> 32) * static_cast<std::uint64_t>(queue_count) >> 32);
+    }
+
+    /**
+     * Pop from the first non-empty sub-heap, waiting for the locks;
+     * used when random sampling keeps finding empty sub-heaps
+     */
+    std::optional<T> scan() {
+        int start = randomQueue();
+        for (int k = 0; k < queue_count; ++k) {
+            Queue & q = *queues[(start + k) % queue_count];
+            if (q.size.load(std::memory_order_relaxed) == 0) continue;
+            q.lock();
+            if (q.heap.size() > 0) {
+                T top = q.heap.pop();
+                q.unlock();
+                return top;
+            }
+            q.unlock();
+        }
+        return std::nullopt;
+    }
+
+public:
+    /**
+     * @param threads   number of threads which will use the queue
+     * @param c         number of sub-heaps per thread
+     * @param comp
+     */
+    explicit MultiQueue(int threads = static_cast<int>(std::thread::hardware_concurrency()), int c = 2,
+                        Compare comp = Compare())
+        : queue_count(std::max(2, std::max(1, threads) * c)), compare(comp) {
+        if (c < 1) {
+            throw std::invalid_argument("MultiQueue needs at least one sub-heap per thread");
+        }
+        queues.reserve(queue_count);
+        for (int i = 0; i < queue_count; ++i) {
+            queues.push_back(std::make_unique<Queue>(comp));
+        }
+    }
+    MultiQueue(const MultiQueue &) = delete;
+    MultiQueue& operator=(const MultiQueue &) = delete;
+
+    /**
+     * @return      number of sub-heaps
+     */
+    int queues_count() const {
+        return queue_count;
+    }
+
+    /**
+     * Number of elements; exact only when no thread modifies the queue
+     */
+    int size() const {
+        int total = 0;
+        for (int i = 0; i < queue_count; ++i) {
+            total += queues[i]->size.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    void insert(const T & key) {
+        insert(T(key));
+    }
+
+    void insert(T && key) {
+        while (true) {
+            Queue & q = *queues[randomQueue()];
+            if (q.try_lock()) {
+                q.heap.insert(std::move(key));
+                q.unlock();
+                return;
+            }
+        }
+    }
+
+    /**
+     * Construct the element from args and add it to the queue
+     * @param args      arguments of the T constructor
+     */
+    template <class... Args>
+    void emplace(Args&&... args) {
+        insert(T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * Pop the better of the tops of two random sub-heaps
+     * @return      the element or nullopt if the queue is empty
+     */
+    std::optional<T> try_pop() {
+        for (int attempt = 0; attempt < 2 * queue_count; ++attempt) {
+            int i = randomQueue(), j = randomQueue();
+            if (i == j) continue;
+            Queue & a = *queues[i];
+            Queue & b = *queues[j];
+            if (a.size.load(std::memory_order_relaxed) == 0 && b.size.load(std::memory_order_relaxed) == 0) continue;
+            if (!a.try_lock()) continue;
+            if (!b.try_lock()) {
+                a.unlock();
+                continue;
+            }
+            Queue* best = &a;
+            if (a.heap.size() == 0 || (b.heap.size() > 0 && compare(a.heap.top(), b.heap.top()))) {
+                best = &b;
+            }
+            std::optional<T> top;
+            if (best->heap.size() > 0) {
+                top = best->heap.pop();
+            }
+            a.unlock();
+            b.unlock();
+            if (top) {
+                return top;
+            }
+        }
+        return scan();
+    }
+
+    /**
+     * Pop an element, which is near the top of the queue
+     * @return      the element
+     */
+    T pop() {
+        std::optional<T> top = try_pop();
+        if (!top) {
+            throw std::out_of_range("Heap is empty");
+        }
+        return std::move(*top);
+    }
+};
+
+#endif //ALGORITHMS_MULTI_QUEUE_HPP
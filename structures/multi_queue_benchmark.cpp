@@ -0,0 +1,176 @@
+#include "heap.hpp"
+#include "multi_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * Heap behind a single mutex, the baseline which serializes all threads
+ */
+class LockedHeap {
+    std::mutex mutex;
+    Heap<std::uint32_t, std::greater<>> heap;
+
+public:
+    void insert(std::uint32_t key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        heap.insert(key);
+    }
+    bool try_pop(std::uint32_t & key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (heap.size() == 0) {
+            return false;
+        }
+        key = heap.pop();
+        return true;
+    }
+};
+
+bool try_pop(LockedHeap & queue, std::uint32_t & key) {
+    return queue.try_pop(key);
+}
+
+bool try_pop(MultiQueue<std::uint32_t, std::greater<>> & queue, std::uint32_t & key) {
+    auto top = queue.try_pop();
+    if (top) {
+        key = *top;
+    }
+    return top.has_value();
+}
+
+/**
+ * Prefill the queue with n keys, then every thread alternates pop and push
+ * of a slightly larger key, as a best-first search expanding nodes
+ */
+template <class Queue>
+void bench_throughput(const std::string & name, Queue & queue, int threads, std::size_t n, std::size_t ops) {
+    std::mt19937 gen(2024);
+    for (std::size_t i = 0; i < n; i++) {
+        queue.insert(gen() % 1000000);
+    }
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&queue, t, threads, ops]() {
+            std::mt19937 local(t);
+            std::uint32_t key;
+            for (std::size_t i = t; i < ops; i += threads) {
+                if (try_pop(queue, key)) {
+                    queue.insert(key + 1 + local() % 1000);
+                }
+            }
+        });
+    }
+    for (auto & w : workers) {
+        w.join();
+    }
+    std::cout << "  " << name << ", " << threads << " threads: " << ops / elapsed_ms(start) / 1000.0
+              << " M pop+push/s" << std::endl;
+}
+
+/**
+ * Fenwick tree over the keys 0..n-1 which are still in the queue
+ */
+class RankCounter {
+    std::vector<int> tree;
+
+public:
+    explicit RankCounter(std::size_t n) : tree(n + 1, 0) { }
+    void add(std::size_t key, int delta) {
+        for (std::size_t i = key + 1; i < tree.size(); i += i & (~i + 1)) {
+            tree[i] += delta;
+        }
+    }
+    /**
+     * @return      number of keys smaller than key
+     */
+    int less(std::size_t key) const {
+        int count = 0;
+        for (std::size_t i = key; i > 0; i -= i & (~i + 1)) {
+            count += tree[i];
+        }
+        return count;
+    }
+};
+
+/**
+ * Rank error of the pops: how many keys in the queue were better than the
+ * popped one. The threads pop concurrently and log the keys; the ranks are
+ * computed afterwards in the order of the pops in the log, which is the
+ * linearization order of the pops up to the ordering of the log appends.
+ */
+void bench_rank_error(int threads, int c, std::size_t n) {
+    MultiQueue<std::uint32_t, std::greater<>> queue(threads, c);
+    std::vector<std::uint32_t> keys(n);
+    for (std::size_t i = 0; i < n; i++) {
+        keys[i] = static_cast<std::uint32_t>(i);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(2024));
+    for (auto key : keys) {
+        queue.insert(key);
+    }
+    std::vector<std::uint32_t> log(n);
+    std::atomic<std::size_t> next{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&queue, &log, &next]() {
+            while (auto key = queue.try_pop()) {
+                log[next.fetch_add(1)] = *key;
+            }
+        });
+    }
+    for (auto & w : workers) {
+        w.join();
+    }
+    RankCounter remaining(n);
+    for (std::size_t i = 0; i < n; i++) {
+        remaining.add(i, 1);
+    }
+    double total = 0;
+    int worst = 0;
+    for (auto key : log) {
+        int rank = remaining.less(key);
+        total += rank;
+        worst = std::max(worst, rank);
+        remaining.add(key, -1);
+    }
+    std::cout << "  " << threads << " threads, c = " << c << " (" << queue.queues_count() << " heaps): mean rank error "
+              << total / static_cast<double>(n) << ", max " << worst << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    int max_threads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::max(4u, std::thread::hardware_concurrency()));
+
+    std::cout << "Throughput, " << n << " keys in the queue, " << 4 * n << " pop+push" << std::endl;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        LockedHeap locked;
+        bench_throughput("Heap + mutex", locked, threads, n, 4 * n);
+        MultiQueue<std::uint32_t, std::greater<>> multi(threads, 2);
+        bench_throughput("MultiQueue (c = 2)", multi, threads, n, 4 * n);
+    }
+
+    std::cout << "Rank error, " << n << " keys popped" << std::endl;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        for (int c : {1, 2, 4}) {
+            bench_rank_error(threads, c, n);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * Implementation of a pairing heap with custom comparator and the same
+ * interface as Heap. The heap is a tree whose root is the top element;
+ * insertion and meld link two trees in O(1), and pop merges the subtrees
+ * of the root in two passes in amortized O(log n).
+ * Nodes are allocated with Allocator rebound to the node type.
+ */
+
+#ifndef ALGORITHMS_PAIRING_HEAP_HPP
+#define ALGORITHMS_PAIRING_HEAP_HPP
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+template<typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class PairingHeap {
+    struct Node {
+        T key;
+        Node* child = nullptr;      // first child
+        Node* sibling = nullptr;    // next sibling
+
+        template <class... Args>
+        explicit Node(std::in_place_t, Args&&... args) : key(std::forward<Args>(args)...) { }
+    };
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using Traits = std::allocator_traits<NodeAllocator>;
+
+    Node* root = nullptr;
+    int _size = 0;
+    Compare compare;
+    NodeAllocator node_alloc;
+
+    /**
+     * Make the tree with the lower root the first child of the other root
+     * @return      root of the linked tree
+     */
+    Node* link(Node* a, Node* b) {
+        if (a == nullptr) return b;
+        if (b == nullptr) return a;
+        if (compare(a->key, b->key)) {
+            std::swap(a, b);
+        }
+        b->sibling = a->child;
+        a->child = b;
+        return a;
+    }
+
+    /**
+     * Merge the list of siblings: link them in pairs from left to right,
+     * then link the pairs from right to left
+     */
+    Node* mergePairs(Node* first) {
+        Node* pairs = nullptr;
+        while (first != nullptr) {
+            Node* a = first;
+            Node* b = a->sibling;
+            first = b != nullptr ? b->sibling : nullptr;
+            a->sibling = nullptr;
+            if (b != nullptr) {
+                b->sibling = nullptr;
+            }
+            Node* pair = link(a, b);
+            pair->sibling = pairs;
+            pairs = pair;
+        }
+        Node* result = nullptr;
+        while (pairs != nullptr) {
+            Node* next = pairs->sibling;
+            pairs->sibling = nullptr;
+            result = link(result, pairs);
+            pairs = next;
+        }
+        return result;
+    }
+
+    template <class... Args>
+    Node* create(Args&&... args) {
+        Node* node = Traits::allocate(node_alloc, 1);
+        try {
+            Traits::construct(node_alloc, node, std::in_place, std::forward<Args>(args)...);
+        } catch (...) {
+            Traits::deallocate(node_alloc, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    void destroy(Node* node) {
+        Traits::destroy(node_alloc, node);
+        Traits::deallocate(node_alloc, node, 1);
+    }
+
+public:
+    explicit PairingHeap(Compare comp = Compare(), const Allocator & alloc = Allocator())
+        : compare(comp), node_alloc(alloc) { }
+    PairingHeap(const PairingHeap &) = delete;
+    PairingHeap& operator=(const PairingHeap &) = delete;
+    PairingHeap(PairingHeap && h) noexcept
+        : root(std::exchange(h.root, nullptr)), _size(std::exchange(h._size, 0)),
+          compare(h.compare), node_alloc(h.node_alloc) { }
+    PairingHeap& operator=(PairingHeap && h) noexcept {
+        std::swap(root, h.root);
+        std::swap(_size, h._size);
+        std::swap(compare, h.compare);
+        std::swap(node_alloc, h.node_alloc);
+        return *this;
+    }
+    ~PairingHeap() {
+        clear();
+    }
+
+    int size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * Remove all elements; the trees are flattened into one sibling list
+     * on the way, so no recursion is needed
+     */
+    void clear() {
+        Node* node = root;
+        while (node != nullptr) {
+            if (node->child != nullptr) {
+                Node* last = node->child;
+                while (last->sibling != nullptr) {
+                    last = last->sibling;
+                }
+                last->sibling = node->sibling;
+                node->sibling = node->child;
+            }
+            Node* next = node->sibling;
+            destroy(node);
+            node = next;
+        }
+        root = nullptr;
+        _size = 0;
+    }
+
+    const T & top() const {
+        if (_size == 0) {
+            throw std::out_of_range("Heap is empty");
+        }
+        return root->key;
+    }
+
+    T pop() {
+        if (_size == 0) {
+            throw std::out_of_range("Heap is empty");
+        }
+        Node* old = root;
+        T key = std::move(old->key);
+        root = mergePairs(old->child);
+        destroy(old);
+        --_size;
+        return key;
+    }
+
+    void insert(const T & key) {
+        root = link(root, create(key));
+        ++_size;
+    }
+
+    void insert(T && key) {
+        root = link(root, create(std::move(key)));
+        ++_size;
+    }
+
+    /**
+     * Construct the element from args and add it to the heap
+     * @param args      arguments of the T constructor
+     */
+    template <class... Args>
+    void emplace(Args&&... args) {
+        root = link(root, create(std::forward<Args>(args)...));
+        ++_size;
+    }
+
+    /**
+     * Move all elements of h to this heap in O(1); h becomes empty.
+     * If the allocators differ, the elements are moved one by one instead
+     * @param h
+     */
+    void meld(PairingHeap & h) {
+        if (&h == this) return;
+        if (!(node_alloc == h.node_alloc)) {
+            while (!h.empty()) {
+                insert(h.pop());
+            }
+            return;
+        }
+        root = link(root, std::exchange(h.root, nullptr));
+        _size += std::exchange(h._size, 0);
+    }
+};
+
+#endif //ALGORITHMS_PAIRING_HEAP_HPP
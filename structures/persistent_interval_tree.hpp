@@ -0,0 +1,193 @@
+/**
+ * Persistent variant of IntervalTree: every update returns a new version
+ * and leaves the previous ones intact, so queries can be answered on any
+ * past version. Nodes live in a pool of fixed-size chunks, which grows
+ * without moving them, and refer to their children by index. An update
+ * copies only the O(log n) nodes on the paths to the ends of its range
+ * and their children, and shares the rest with the version it was
+ * applied to. u updates of n values take O(n + u log n) nodes.
+ * Value, Modifier and their operations are as in IntervalTree; a Modifier
+ * has to distribute over +, i.e. m(a + b) = m(a) + m(b).
+ */
+
+#ifndef ALGORITHMS_PERSISTENT_INTERVAL_TREE_HPP
+#define ALGORITHMS_PERSISTENT_INTERVAL_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+template<typename Value, typename Modifier>
+class PersistentIntervalTree {
+    using Index = std::uint32_t;
+
+    struct Node {
+        Value val = Value();
+        Modifier mod = Modifier();
+        Index left = 0, right = 0;
+
+        friend Value operator + (const Node& n1, const Node& n2) {
+            return n1.mod(n1.val) + n2.mod(n2.val);
+        }
+    };
+
+    static constexpr int CHUNK_BITS = 16;
+    static constexpr std::size_t CHUNK_MASK = (std::size_t(1) << CHUNK_BITS) - 1;
+
+    std::size_t N;
+    std::vector<std::unique_ptr<Node[]>> chunks;
+    std::size_t count = 0;
+    std::vector<Index> roots;       // root of every version
+
+    Node & node(Index i) {
+        return chunks[i >> CHUNK_BITS][i & CHUNK_MASK];
+    }
+
+    const Node & node(Index i) const {
+        return chunks[i >> CHUNK_BITS][i & CHUNK_MASK];
+    }
+
+    Index add(const Node & n) {
+        if (count > std::numeric_limits<Index>::max()) {
+            throw std::length_error("PersistentIntervalTree node pool is full");
+        }
+        if ((count & CHUNK_MASK) == 0) {
+            chunks.push_back(std::make_unique<Node[]>(CHUNK_MASK + 1));
+        }
+        Index i = static_cast<Index>(count++);
+        node(i) = n;
+        return i;
+    }
+
+    template <class Leaf>
+    Index build(std::size_t lo, std::size_t hi, Leaf & leaf) {
+        Node n;
+        if (hi - lo == 1) {
+            n.val = leaf(lo);
+            return add(n);
+        }
+        std::size_t mid = lo + (hi - lo) / 2;
+        n.left = build(lo, mid, leaf);
+        n.right = build(mid, hi, leaf);
+        n.val = node(n.left) + node(n.right);
+        return add(n);
+    }
+
+    /**
+     * Copy the node v over [lo, hi) with the modifier pushed from its parent
+     * applied on top, and apply the update to the copy. A node which the
+     * update does not touch is shared unless there is a pushed modifier;
+     * the modifiers of the copied nodes are pushed to their children, as
+     * a later update must not be applied below an earlier modifier.
+     * @return      the index of the new node
+     */
+    Index modify(Index v, std::size_t lo, std::size_t hi, const Modifier * pushed,
+                 std::size_t begin, std::size_t end, const Modifier & modifier) {
+        Node n = node(v);
+        if (pushed) n.mod = *pushed * n.mod;
+        if (end <= lo || hi <= begin) {
+            return pushed ? add(n) : v;
+        }
+        if (begin <= lo && hi <= end) {
+            n.mod = modifier * n.mod;
+            return add(n);
+        }
+        std::size_t mid = lo + (hi - lo) / 2;
+        n.left = modify(n.left, lo, mid, &n.mod, begin, end, modifier);
+        n.right = modify(n.right, mid, hi, &n.mod, begin, end, modifier);
+        n.mod = {};
+        n.val = node(n.left) + node(n.right);
+        return add(n);
+    }
+
+    /**
+     * Combine the values of [begin, end) in the subtree of v over [lo, hi),
+     * which intersect, with the modifiers of the subtree applied
+     */
+    Value collect(Index v, std::size_t lo, std::size_t hi, std::size_t begin, std::size_t end) const {
+        const Node & n = node(v);
+        if (begin <= lo && hi <= end) {
+            return n.mod(n.val);
+        }
+        std::size_t mid = lo + (hi - lo) / 2;
+        if (end <= mid) {
+            return n.mod(collect(n.left, lo, mid, begin, end));
+        }
+        if (begin >= mid) {
+            return n.mod(collect(n.right, mid, hi, begin, end));
+        }
+        return n.mod(collect(n.left, lo, mid, begin, end) + collect(n.right, mid, hi, begin, end));
+    }
+
+    void checkVersion(std::size_t version) const {
+        if (version >= roots.size()) {
+            throw std::out_of_range("Version does not exist");
+        }
+    }
+
+public:
+    /**
+     * Construct version 0 of the tree initializing all values to value
+     * @param n         number of leaves, i.e. size of expected data
+     * @param value     the initial value for nodes
+     */
+    PersistentIntervalTree(std::size_t n, Value value = {}) : N(std::max<std::size_t>(n, 1)) {
+        auto leaf = [&value](std::size_t) { return value; };
+        roots.push_back(build(0, N, leaf));
+    }
+
+    /**
+     * Construct version 0 of the tree initializing the nodes according to values
+     * @param values     the initial values for nodes
+     */
+    PersistentIntervalTree(const std::vector<Value>& values) : N(std::max<std::size_t>(values.size(), 1)) {
+        auto leaf = [&values](std::size_t i) { return i < values.size() ? values[i] : Value(); };
+        roots.push_back(build(0, N, leaf));
+    }
+
+    /**
+     * @return      number of versions, the latest one is versions() - 1
+     */
+    std::size_t versions() const {
+        return roots.size();
+    }
+
+    /**
+     * @return      number of nodes in the pool, shared by all versions
+     */
+    std::size_t nodes() const {
+        return count;
+    }
+
+    /**
+     * Combine the values in [begin, end) of the version
+     * @param version   a version returned by update, or 0
+     */
+    Value query(std::size_t version, std::size_t begin, std::size_t end) const {
+        checkVersion(version);
+        if (begin >= end) return {};
+        return collect(roots[version], 0, N, begin, end);
+    }
+
+    /**
+     * Apply the modifier to the values in [begin, end) of the version,
+     * which stays unchanged
+     * @param version   a version returned by update, or 0
+     * @return          the new version
+     */
+    std::size_t update(std::size_t version, std::size_t begin, std::size_t end, Modifier modifier) {
+        checkVersion(version);
+        Index root = roots[version];
+        if (begin < end) {
+            root = modify(root, 0, N, nullptr, begin, end, modifier);
+        }
+        roots.push_back(root);
+        return roots.size() - 1;
+    }
+};
+
+#endif //ALGORITHMS_PERSISTENT_INTERVAL_TREE_HPP
@@ -0,0 +1,102 @@
+#include "heap.hpp"
+#include "pairing_heap.hpp"
+#include "radix_heap.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+using BinaryHeap = Heap<std::uint32_t, std::greater<>>;
+using Pairing = PairingHeap<std::uint32_t, std::greater<>>;
+
+/**
+ * Heap has no meld, the best it can do is to move all elements
+ * of the source with pop_n and heapify them into the target
+ */
+void meld(BinaryHeap & target, BinaryHeap & source) {
+    target.push_range(source.pop_n(source.size()));
+}
+
+template <class Allocator>
+void meld(PairingHeap<std::uint32_t, std::greater<>, Allocator> & target,
+          PairingHeap<std::uint32_t, std::greater<>, Allocator> & source) {
+    target.meld(source);
+}
+
+/**
+ * Start with `heaps` heaps of n / heaps random keys; then meld two random
+ * heaps and pop from the result until one heap is left
+ */
+template <class HeapType>
+void bench_meld(const std::string & name, std::size_t n, int heaps) {
+    std::mt19937 gen(2024);
+    std::vector<HeapType> pool(heaps);
+    for (std::size_t i = 0; i < n; i++) {
+        pool[i % heaps].insert(gen());
+    }
+    std::uint64_t checksum = 0;
+    auto start = Clock::now();
+    while (pool.size() > 1) {
+        std::size_t a = gen() % pool.size(), b = gen() % (pool.size() - 1);
+        b += b >= a;
+        meld(pool[a], pool[b]);
+        if (pool[a].size() > 0) {
+            checksum += pool[a].pop();
+        }
+        std::swap(pool[b], pool.back());
+        pool.pop_back();
+    }
+    checksum += pool[0].size();
+    std::cout << "  " << name << ": " << elapsed_ms(start) << " ms (checksum " << checksum % 1000 << ")" << std::endl;
+}
+
+/**
+ * Hold model with monotone keys, as the distances in Dijkstra's algorithm:
+ * keep n keys in the heap and replace the minimum by a larger key m times
+ */
+template <class HeapType>
+void bench_monotone(const std::string & name, std::size_t n, std::size_t m, std::uint32_t max_step) {
+    std::mt19937 gen(2024);
+    HeapType heap;
+    for (std::size_t i = 0; i < n; i++) {
+        heap.insert(gen() % max_step);
+    }
+    std::uint64_t checksum = 0;
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < m; i++) {
+        std::uint32_t key = heap.pop();
+        checksum += key;
+        heap.insert(key + 1 + gen() % max_step);
+    }
+    std::cout << "  " << name << ": " << 1000.0 * m / elapsed_ms(start) / 1e6 << " M pop+push/s (checksum "
+              << checksum % 1000 << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    int heaps = argc > 2 ? std::atoi(argv[2]) : 10000;
+
+    std::cout << "Meld-heavy: " << n << " keys in " << heaps << " heaps melded into one" << std::endl;
+    bench_meld<BinaryHeap>("Heap (pop_n + push_range)", n, heaps);
+    bench_meld<Pairing>("PairingHeap (meld)", n, heaps);
+    std::cout << "  RadixHeap: not meldable" << std::endl;
+
+    for (std::uint32_t step : {100u, 1000000u}) {
+        std::cout << "Monotone keys: " << n << " keys, " << 10 * n << " pop+push, steps up to " << step << std::endl;
+        bench_monotone<BinaryHeap>("Heap", n, 10 * n, step);
+        bench_monotone<Pairing>("PairingHeap", n, 10 * n, step);
+        bench_monotone<RadixHeap<std::uint32_t>>("RadixHeap", n, 10 * n, step);
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * Implementation of a monotone radix heap for non-negative integer keys,
+ * with the same interface as a min-heap. The heap is monotone: a new key
+ * must not be smaller than the last popped (or read by top) one, which holds
+ * e.g. for distances in Dijkstra's algorithm. An element of bucket b has a key
+ * that differs from the last popped key first in bit b-1 (bucket 0 holds
+ * the keys equal to it), so insertion is O(1) and an element moves to
+ * a lower bucket at most once per bit of the key, which gives amortized
+ * O(log C) pops for keys up to C.
+ *
+ * T is either the key itself or contains it; KeyOf extracts the key,
+ * e.g. FirstKey for pairs of a distance and a vertex.
+ */
+
+#ifndef ALGORITHMS_RADIX_HEAP_HPP
+#define ALGORITHMS_RADIX_HEAP_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Key of a pair, for the heaps of (key, value) pairs
+ */
+struct FirstKey {
+    template <class P>
+    constexpr auto operator()(const P & p) const {
+        return p.first;
+    }
+};
+
+template<typename T, typename KeyOf = std::identity>
+class RadixHeap {
+    using RawKey = std::remove_cvref_t<std::invoke_result_t<const KeyOf&, const T&>>;
+    static_assert(std::integral<RawKey>, "radix heap keys have to be integers");
+    using Key = std::make_unsigned_t<RawKey>;
+    static constexpr int BUCKETS = std::numeric_limits<Key>::digits + 1;
+
+    // the buckets are refilled when the heap is read, so top can be const
+    mutable std::array<std::vector<T>, BUCKETS> buckets;
+    mutable Key last = 0;
+    int _size = 0;
+    KeyOf key_of;
+
+    Key key(const T & x) const {
+        RawKey k = key_of(x);
+        if constexpr (std::is_signed_v<RawKey>) {
+            if (k < 0) {
+                throw std::invalid_argument("Radix heap keys have to be non-negative");
+            }
+        }
+        return static_cast<Key>(k);
+    }
+
+    int bucket(Key k) const {
+        return std::bit_width(static_cast<Key>(k ^ last));
+    }
+
+    /**
+     * Make bucket 0 non-empty: the minimum of the first non-empty bucket
+     * becomes the last key, and the elements of that bucket are
+     * redistributed to lower buckets relative to it
+     */
+    void refill() const {
+        if (!buckets[0].empty()) return;
+        int b = 1;
+        while (buckets[b].empty()) {
+            ++b;
+        }
+        auto & from = buckets[b];
+        Key min = key(from[0]);
+        for (const T & x : from) {
+            min = std::min(min, key(x));
+        }
+        last = min;
+        for (T & x : from) {
+            buckets[bucket(key(x))].push_back(std::move(x));
+        }
+        from.clear();
+    }
+
+public:
+    explicit RadixHeap(KeyOf k = KeyOf()) : key_of(k) { }
+
+    int size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * @return      element with the smallest key
+     */
+    const T & top() const {
+        if (_size == 0) {
+            throw std::out_of_range("Heap is empty");
+        }
+        refill();
+        return buckets[0].back();
+    }
+
+    T pop() {
+        if (_size == 0) {
+            throw std::out_of_range("Heap is empty");
+        }
+        refill();
+        T x = std::move(buckets[0].back());
+        buckets[0].pop_back();
+        --_size;
+        return x;
+    }
+
+    /**
+     * Add the element; its key must not be less than the key of the last
+     * popped element or of the last top
+     * @param x
+     */
+    void insert(const T & x) {
+        insert(T(x));
+    }
+
+    void insert(T && x) {
+        Key k = key(x);
+        if (k < last) {
+            throw std::invalid_argument("Key is less than the last popped key");
+        }
+        buckets[bucket(k)].push_back(std::move(x));
+        ++_size;
+    }
+
+    /**
+     * Construct the element from args and add it to the heap
+     * @param args      arguments of the T constructor
+     */
+    template <class... Args>
+    void emplace(Args&&... args) {
+        insert(T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * Remove all elements and allow any keys again
+     */
+    void clear() {
+        for (auto & b : buckets) {
+            b.clear();
+        }
+        last = 0;
+        _size = 0;
+    }
+};
+
+#endif //ALGORITHMS_RADIX_HEAP_HPP
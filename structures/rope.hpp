@@ -0,0 +1,331 @@
+/**
+ * Sequence of elements stored in an implicit treap: a binary tree in the
+ * order of the sequence, keyed by position through subtree sizes and
+ * balanced by random heap priorities. Split at a position and concat of
+ * two sequences take expected O(log n), and so does reverse(l, r), which
+ * cuts out the range and marks its root as reversed; the mark is pushed
+ * down lazily, swapping the children, when a node is visited.
+ * Nodes are allocated with Allocator rebound to the node type.
+ */
+
+#ifndef ALGORITHMS_ROPE_HPP
+#define ALGORITHMS_ROPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+template<typename T, typename Allocator = std::allocator<T>>
+class Rope {
+    struct Node {
+        T value;
+        Node* left = nullptr;
+        Node* right = nullptr;
+        std::size_t size = 1;
+        std::uint32_t priority;
+        bool reversed = false;      // the children of the subtree are still to be swapped
+
+        template <class... Args>
+        explicit Node(std::uint32_t p, std::in_place_t, Args&&... args)
+            : value(std::forward<Args>(args)...), priority(p) { }
+    };
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using Traits = std::allocator_traits<NodeAllocator>;
+
+    Node* root = nullptr;
+    std::uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    NodeAllocator node_alloc;
+
+    std::uint32_t random() {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return static_cast<std::uint32_t>(seed >> 32);
+    }
+
+    template <class... Args>
+    Node* create(Args&&... args) {
+        Node* node = Traits::allocate(node_alloc, 1);
+        try {
+            Traits::construct(node_alloc, node, random(), std::in_place, std::forward<Args>(args)...);
+        } catch (...) {
+            Traits::deallocate(node_alloc, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    void destroy(Node* node) {
+        Traits::destroy(node_alloc, node);
+        Traits::deallocate(node_alloc, node, 1);
+    }
+
+    static std::size_t size(const Node* t) {
+        return t ? t->size : 0;
+    }
+
+    static void update(Node* t) {
+        t->size = 1 + size(t->left) + size(t->right);
+    }
+
+    /**
+     * Swap the children of a reversed node and pass the mark to them
+     */
+    static void push(Node* t) {
+        if (!t->reversed) return;
+        std::swap(t->left, t->right);
+        if (t->left) t->left->reversed = !t->left->reversed;
+        if (t->right) t->right->reversed = !t->right->reversed;
+        t->reversed = false;
+    }
+
+    /**
+     * Split t into its first k elements and the rest
+     */
+    static std::pair<Node*, Node*> split(Node* t, std::size_t k) {
+        if (!t) return { nullptr, nullptr };
+        push(t);
+        if (size(t->left) >= k) {
+            auto [a, b] = split(t->left, k);
+            t->left = b;
+            update(t);
+            return { a, t };
+        }
+        auto [a, b] = split(t->right, k - size(t->left) - 1);
+        t->right = a;
+        update(t);
+        return { t, b };
+    }
+
+    /**
+     * Concatenate a and b, the root with the higher priority stays on top
+     */
+    static Node* merge(Node* a, Node* b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (a->priority > b->priority) {
+            push(a);
+            a->right = merge(a->right, b);
+            update(a);
+            return a;
+        }
+        push(b);
+        b->left = merge(a, b->left);
+        update(b);
+        return b;
+    }
+
+    void checkRange(std::size_t l, std::size_t r) const {
+        if (l > r || r > size()) {
+            throw std::out_of_range("Rope range is out of bounds");
+        }
+    }
+
+public:
+    explicit Rope(const Allocator & alloc = Allocator()) : node_alloc(alloc) { }
+
+    /**
+     * Construct the rope of the values in O(n): every new node on the
+     * right of the tree goes below the last node on the rightmost path
+     * with a higher priority
+     * @param values    the elements in order
+     */
+    explicit Rope(const std::vector<T> & values, const Allocator & alloc = Allocator()) : node_alloc(alloc) {
+        std::vector<Node*> right_path;
+        try {
+            for (const T & value : values) {
+                Node* node = create(value);
+                Node* last = nullptr;
+                while (!right_path.empty() && right_path.back()->priority < node->priority) {
+                    last = right_path.back();
+                    right_path.pop_back();
+                    update(last);
+                }
+                node->left = last;
+                if (!right_path.empty()) right_path.back()->right = node;
+                right_path.push_back(node);
+            }
+        } catch (...) {
+            root = right_path.empty() ? nullptr : right_path.front();
+            clear();
+            throw;
+        }
+        for (auto it = right_path.rbegin(); it != right_path.rend(); ++it) {
+            update(*it);
+        }
+        root = right_path.empty() ? nullptr : right_path.front();
+    }
+
+    Rope(const Rope &) = delete;
+    Rope& operator=(const Rope &) = delete;
+    Rope(Rope && r) noexcept
+        : root(std::exchange(r.root, nullptr)), seed(r.seed), node_alloc(r.node_alloc) { }
+    Rope& operator=(Rope && r) noexcept {
+        std::swap(root, r.root);
+        std::swap(seed, r.seed);
+        std::swap(node_alloc, r.node_alloc);
+        return *this;
+    }
+    ~Rope() {
+        clear();
+    }
+
+    std::size_t size() const {
+        return size(root);
+    }
+
+    bool empty() const {
+        return root == nullptr;
+    }
+
+    /**
+     * Remove all elements without recursion: the left subtree of a node
+     * is rotated up until the node has none, then the node is freed
+     */
+    void clear() {
+        Node* t = root;
+        while (t) {
+            if (t->left) {
+                Node* l = t->left;
+                t->left = l->right;
+                l->right = t;
+                t = l;
+            } else {
+                Node* next = t->right;
+                destroy(t);
+                t = next;
+            }
+        }
+        root = nullptr;
+    }
+
+    /**
+     * @param i     position in the sequence
+     * @return      the element at position i
+     */
+    T & at(std::size_t i) {
+        if (i >= size()) {
+            throw std::out_of_range("Rope index is out of bounds");
+        }
+        Node* t = root;
+        while (true) {
+            push(t);
+            if (i < size(t->left)) {
+                t = t->left;
+            } else if (i == size(t->left)) {
+                return t->value;
+            } else {
+                i -= size(t->left) + 1;
+                t = t->right;
+            }
+        }
+    }
+
+    /**
+     * Insert element constructed from args before position i
+     * @param i         position in [0, size()]
+     * @param args      arguments of the T constructor
+     */
+    template <class... Args>
+    void emplace(std::size_t i, Args&&... args) {
+        checkRange(i, i);
+        Node* node = create(std::forward<Args>(args)...);
+        auto [a, b] = split(root, i);
+        root = merge(merge(a, node), b);
+    }
+
+    void insert(std::size_t i, const T & value) {
+        emplace(i, value);
+    }
+
+    void push_back(const T & value) {
+        root = merge(root, create(value));
+    }
+
+    void push_back(T && value) {
+        root = merge(root, create(std::move(value)));
+    }
+
+    /**
+     * Remove the element at position i
+     * @param i     position in the sequence
+     */
+    void erase(std::size_t i) {
+        checkRange(i, i + 1);
+        auto [a, rest] = split(root, i);
+        auto [node, b] = split(rest, 1);
+        destroy(node);
+        root = merge(a, b);
+    }
+
+    /**
+     * Reverse the order of the elements in [l, r)
+     */
+    void reverse(std::size_t l, std::size_t r) {
+        checkRange(l, r);
+        auto [a, rest] = split(root, l);
+        auto [middle, b] = split(rest, r - l);
+        if (middle) middle->reversed = !middle->reversed;
+        root = merge(merge(a, middle), b);
+    }
+
+    /**
+     * Add all elements of R to the end of this rope; R becomes empty.
+     * If the allocators differ, the elements are copied one by one
+     * @param R
+     */
+    void concat(Rope & R) {
+        if (!(node_alloc == R.node_alloc)) {
+            for (T & value : R.to_vector()) {
+                push_back(std::move(value));
+            }
+            R.clear();
+            return;
+        }
+        root = merge(root, std::exchange(R.root, nullptr));
+    }
+
+    /**
+     * Cut the rope before position i
+     * @param i     position in [0, size()]
+     * @return      rope of the elements from position i on, which are removed
+     */
+    Rope split(std::size_t i) {
+        checkRange(i, i);
+        Rope rest(node_alloc);
+        rest.seed = random() | 1;
+        auto [a, b] = split(root, i);
+        root = a;
+        rest.root = b;
+        return rest;
+    }
+
+    /**
+     * @return      the elements in order
+     */
+    std::vector<T> to_vector() const {
+        std::vector<T> result;
+        result.reserve(size());
+        std::vector<std::pair<const Node*, bool>> stack;     // node and whether it is seen reversed
+        const Node* t = root;
+        bool flip = false;
+        while (t || !stack.empty()) {
+            while (t) {
+                flip ^= t->reversed;
+                stack.push_back({ t, flip });
+                t = flip ? t->right : t->left;
+            }
+            auto [node, node_flip] = stack.back();
+            stack.pop_back();
+            result.push_back(node->value);
+            flip = node_flip;
+            t = flip ? node->left : node->right;
+        }
+        return result;
+    }
+};
+
+#endif //ALGORITHMS_ROPE_HPP
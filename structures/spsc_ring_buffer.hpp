@@ -0,0 +1,126 @@
+/**
+ * Bounded lock-free queue for one producer and one consumer thread, with
+ * the push_back, pop_front and empty operations of DoubleList. Elements
+ * are stored by value in a ring of a power-of-two capacity. The producer
+ * owns the tail index and the consumer the head index; each thread keeps
+ * a cached copy of the other's index, which it reloads only when the
+ * ring looks full or empty, so the two cache lines are rarely shared.
+ */
+
+#ifndef ALGORITHMS_SPSC_RING_BUFFER_HPP
+#define ALGORITHMS_SPSC_RING_BUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+
+template<typename T>
+class SpscRingBuffer {
+    struct alignas(64) Index {
+        std::atomic<std::size_t> value{0};
+        std::size_t cached = 0;     // the other thread's index when last read
+    };
+
+    struct Slot {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    std::size_t mask;
+    std::unique_ptr<Slot[]> slots;
+    Index head;     // next element to pop, written by the consumer
+    Index tail;     // next free slot, written by the producer
+
+    T* slot(std::size_t i) {
+        return std::launder(reinterpret_cast<T*>(slots[i & mask].bytes));
+    }
+
+public:
+    /**
+     * @param capacity  maximum number of elements, rounded up to a power of two
+     */
+    explicit SpscRingBuffer(std::size_t capacity = 1024)
+        : mask(std::bit_ceil(std::max<std::size_t>(capacity, 1)) - 1),
+          slots(new Slot[mask + 1]) { }
+    SpscRingBuffer(const SpscRingBuffer &) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer &) = delete;
+    ~SpscRingBuffer() {
+        while (pop_front()) { }
+    }
+
+    std::size_t capacity() const {
+        return mask + 1;
+    }
+
+    /**
+     * Called by the consumer; from the producer it may be outdated
+     */
+    bool empty() const {
+        return head.value.load(std::memory_order_relaxed) == tail.value.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Add element constructed from args to the end, called by the producer
+     * @param args      arguments of the T constructor
+     * @return          false if the ring is full
+     */
+    template <class... Args>
+    bool try_emplace_back(Args&&... args) {
+        std::size_t t = tail.value.load(std::memory_order_relaxed);
+        if (t - tail.cached > mask) {
+            tail.cached = head.value.load(std::memory_order_acquire);
+            if (t - tail.cached > mask) return false;
+        }
+        ::new (static_cast<void*>(slot(t))) T(std::forward<Args>(args)...);
+        tail.value.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push_back(const T & name) {
+        return try_emplace_back(name);
+    }
+
+    bool try_push_back(T && name) {
+        return try_emplace_back(std::move(name));
+    }
+
+    /**
+     * Add element to the end, waiting for room if the ring is full;
+     * called by the producer
+     */
+    void push_back(const T & name) {
+        while (!try_emplace_back(name)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void push_back(T && name) {
+        while (!try_emplace_back(std::move(name))) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * Remove the first element, called by the consumer
+     * @return      the element or nullopt if the ring is empty
+     */
+    std::optional<T> pop_front() {
+        std::size_t h = head.value.load(std::memory_order_relaxed);
+        if (h == head.cached) {
+            head.cached = tail.value.load(std::memory_order_acquire);
+            if (h == head.cached) return std::nullopt;
+        }
+        T* x = slot(h);
+        std::optional<T> result(std::move(*x));
+        std::destroy_at(x);
+        head.value.store(h + 1, std::memory_order_release);
+        return result;
+    }
+};
+
+#endif //ALGORITHMS_SPSC_RING_BUFFER_HPP
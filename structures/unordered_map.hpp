@@ -2,105 +2,293 @@
  * An implementation of unordered map template
  * using the cuckoo hashing which gives the amortised cost
  * of insertion and deletion operations O(1).
+ * The two tables are indexed by independent hashers Hash1 and Hash2
+ * (see hashing.hpp) and have a power of two capacity.
+ * Nodes are allocated with Allocator rebound to the node type, e.g.
+ * PoolAllocator from memory_pool.hpp. With transparent hashers
+ * (as the default ones for std::string) find, erase and operator[]
+ * accept e.g. std::string_view without constructing a Key.
  */
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "hashing.hpp"
+#include "memory_pool.hpp"
 #ifndef ALGORITHMS_UNORDERED_MAP_H
 #define ALGORITHMS_UNORDERED_MAP_H
 
-
-template <class Key, class Value>
-struct Node {
-    std::pair<Key, Value> p;
-    Node<Key, Value>* next = nullptr;
-    Node<Key, Value>* prev = nullptr;
-};
-
-template <class Key, class Value>
+template <class Key, class Value, class Hash1 = MultiplyShiftHash<Key>, class Hash2 = WyHash<Key>,
+          class Allocator = std::allocator<std::pair<Key, Value>>>
 class UnorderedMap {
 public:
+    struct Node {
+        std::pair<Key, Value> p;
+        Node* next = nullptr;
+        Node* prev = nullptr;
+
+        Node() = default;
+        template <class... Args>
+        explicit Node(std::in_place_t, Args&&... args) : p(std::forward<Args>(args)...) { }
+    };
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
     class Iterator;
     class LinkedList;
     LinkedList list;
-    Node<Key, Value>** tab1;
-    Node<Key, Value>** tab2;
-    int map_size = 0, capacity = 127;
+    Node** tab1;
+    Node** tab2;
+    int map_size = 0, capacity = 128;
+    int shift = 64 - std::countr_zero(128u);
+    std::size_t rehash_count = 0;
+    std::uint64_t seed = 0;
+    bool seeded = false;
+    Hash1 hash1;
+    Hash2 hash2;
+
+    /**
+     * Shared table of 128 empty slots used by maps whose tables were moved
+     * out or cleared; it is only read, since link allocates tables
+     * of the map before writing to them
+     */
+    static Node** emptyTable() {
+        static Node* table[128] = {};
+        return table;
+    }
+    void allocateTables() {
+        auto new1 = std::make_unique<Node*[]>(capacity);
+        auto new2 = std::make_unique<Node*[]>(capacity);
+        tab1 = new1.release();
+        tab2 = new2.release();
+    }
+    void freeTables() {
+        if (tab1 != emptyTable()) {
+            delete[] tab1; delete[] tab2;
+        }
+    }
 
-    UnorderedMap() {
-        tab1 = new Node<Key, Value>*[capacity];
-        tab2 = new Node<Key, Value>*[capacity];
-        std::fill_n(tab1, capacity, nullptr);
-        std::fill_n(tab2, capacity, nullptr);
-    }
-    UnorderedMap(const UnorderedMap & m) : capacity(m.capacity) {
-        tab1 = new Node<Key, Value>*[capacity];
-        tab2 = new Node<Key, Value>*[capacity];
-        std::fill_n(tab1, capacity, nullptr);
-        std::fill_n(tab2, capacity, nullptr);
-        for (auto n : m) {
+    explicit UnorderedMap(const Allocator & alloc = Allocator()) : list(NodeAllocator(alloc)), hash1(0), hash2(1) {
+        allocateTables();
+    }
+    /**
+     * Construct the map with hash functions drawn from the seed. When the
+     * tables cannot be rebuilt, new functions are drawn instead of doubling
+     * the capacity again, so keys chosen without knowing the seed
+     * cannot force repeated rehashes.
+     * @param _seed     e.g. obtained from std::random_device
+     */
+    explicit UnorderedMap(std::uint64_t _seed, const Allocator & alloc = Allocator())
+        : list(NodeAllocator(alloc)), seed(_seed), seeded(true), hash1(_seed), hash2(_seed + 1) {
+        allocateTables();
+    }
+    UnorderedMap(const UnorderedMap & m)
+        : list(std::allocator_traits<NodeAllocator>::select_on_container_copy_construction(m.list.alloc)),
+          capacity(m.capacity), shift(m.shift), seed(m.seed),
+          seeded(m.seeded), hash1(m.hash1), hash2(m.hash2) {
+        allocateTables();
+        for (const auto & n : m) {
             insert(n);
         }
     }
+    /**
+     * Take the nodes and tables of m without allocating. m is left empty
+     * with the shared empty table and a copy of the allocator, and
+     * allocates new tables and list ends on its next insertion.
+     * @param m
+     */
+    UnorderedMap(UnorderedMap && m) noexcept
+        : list(std::move(m.list)), tab1(m.tab1), tab2(m.tab2), map_size(m.map_size),
+          capacity(m.capacity), shift(m.shift), rehash_count(m.rehash_count), seed(m.seed),
+          seeded(m.seeded), hash1(m.hash1), hash2(m.hash2) {
+        m.tab1 = m.tab2 = emptyTable();
+        m.map_size = 0; m.capacity = 128;
+        m.shift = 64 - std::countr_zero(128u);
+    }
     ~UnorderedMap() {
-        delete[] tab1; delete[] tab2;
+        freeTables();
         list.clearList();
     }
     UnorderedMap& operator=(const UnorderedMap & m) {
         if (&m == this) {
             return *this;
         }
-        delete[] tab1; delete[] tab2;
-        capacity = m.capacity;
+        freeTables();
+        capacity = m.capacity; shift = m.shift;
+        seed = m.seed; seeded = m.seeded;
+        hash1 = m.hash1; hash2 = m.hash2;
         list.clearList();
-        tab1 = new Node<Key, Value>*[capacity];
-        tab2 = new Node<Key, Value>*[capacity];
-        std::fill_n(tab1, capacity, nullptr);
-        std::fill_n(tab2, capacity, nullptr);
-        for (auto n : m) {
+        map_size = 0;
+        allocateTables();
+        for (const auto & n : m) {
             insert(n);
         }
         return *this;
     }
+    /**
+     * Exchange the contents with m, whose old elements
+     * are freed together with m
+     * @param m
+     */
+    UnorderedMap& operator=(UnorderedMap && m) noexcept {
+        swap(m);
+        return *this;
+    }
+    void swap(UnorderedMap & m) noexcept {
+        std::swap(list.head, m.list.head);
+        std::swap(list.tail, m.list.tail);
+        std::swap(list.alloc, m.list.alloc);
+        std::swap(tab1, m.tab1);
+        std::swap(tab2, m.tab2);
+        std::swap(map_size, m.map_size);
+        std::swap(capacity, m.capacity);
+        std::swap(shift, m.shift);
+        std::swap(rehash_count, m.rehash_count);
+        std::swap(seed, m.seed);
+        std::swap(seeded, m.seeded);
+        std::swap(hash1, m.hash1);
+        std::swap(hash2, m.hash2);
+    }
 
-    std::size_t getHash1(const Key& key) {
-        std::size_t hash = std::hash<Key>()(key);
-        return hash % capacity;
+    /**
+     * K can be used to look up keys without constructing a Key if it is Key
+     * itself or both hashers are transparent, i.e. they hash K equally
+     * to the Key it compares equal to
+     */
+    template <class K>
+    static constexpr bool is_lookup_key = std::is_same_v<K, Key> ||
+        (requires { typename Hash1::is_transparent; typename Hash2::is_transparent; } &&
+         !std::is_convertible_v<const K &, const Iterator &>);
+
+    template <class K>
+    std::size_t getHash1(const K & key) {
+        return hash1(key) >> shift;
     }
-    std::size_t getHash2(const Key & key) {
-        std::size_t hash = std::hash<Key>()(key);
-        return ((hash >> 32) ^ (hash * 1696969)) % capacity;
+    template <class K>
+    std::size_t getHash2(const K & key) {
+        return hash2(key) >> shift;
     }
+    /**
+     * Insert the pair, or assign its value if the key is already present
+     * @param p
+     * @return      iterator to the element and true if it was inserted
+     */
     std::pair<Iterator, bool> insert(const std::pair<Key, Value> & p) {
         Iterator it = find(p.first);
         if (it != end()) {
             it->second = p.second;
             return std::pair<Iterator, bool>(it, false);
         }
-        auto* n = new Node<Key, Value>;
-        n->p = p;
-        Node<Key, Value>* stored_n = n;
+        return std::pair<Iterator, bool>(link(list.create(p)), true);
+    }
+    std::pair<Iterator, bool> insert(std::pair<Key, Value> && p) {
+        Iterator it = find(p.first);
+        if (it != end()) {
+            it->second = std::move(p.second);
+            return std::pair<Iterator, bool>(it, false);
+        }
+        return std::pair<Iterator, bool>(link(list.create(std::move(p))), true);
+    }
+    /**
+     * Construct the pair in place from args. If the key is already
+     * present, the new pair is dropped and the map is not changed.
+     * @param args      arguments of the std::pair<Key, Value> constructor
+     * @return          iterator to the element and true if it was inserted
+     */
+    template <class... Args>
+    std::pair<Iterator, bool> emplace(Args&&... args) {
+        Node* n = list.create(std::forward<Args>(args)...);
+        Iterator it = find(n->p.first);
+        if (it != end()) {
+            list.destroy(n);
+            return std::pair<Iterator, bool>(it, false);
+        }
+        return std::pair<Iterator, bool>(link(n), true);
+    }
+    /**
+     * Construct the value from args only if the key is not present,
+     * otherwise neither the key nor args are touched
+     * @param key
+     * @param args      arguments of the Value constructor
+     * @return          iterator to the element and true if it was inserted
+     */
+    template <class... Args>
+    std::pair<Iterator, bool> try_emplace(const Key & key, Args&&... args) {
+        Iterator it = find(key);
+        if (it != end()) {
+            return std::pair<Iterator, bool>(it, false);
+        }
+        Node* n = list.create(std::piecewise_construct, std::forward_as_tuple(key),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+        return std::pair<Iterator, bool>(link(n), true);
+    }
+    template <class... Args>
+    std::pair<Iterator, bool> try_emplace(Key && key, Args&&... args) {
+        Iterator it = find(key);
+        if (it != end()) {
+            return std::pair<Iterator, bool>(it, false);
+        }
+        Node* n = list.create(std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+        return std::pair<Iterator, bool>(link(n), true);
+    }
+    /**
+     * Heterogeneous try_emplace: Key is constructed from key only
+     * if it is not present
+     */
+    template <class K, class... Args>
+        requires (!std::is_same_v<std::remove_cvref_t<K>, Key> && is_lookup_key<std::remove_cvref_t<K>>)
+    std::pair<Iterator, bool> try_emplace(K && key, Args&&... args) {
+        Iterator it = find(key);
+        if (it != end()) {
+            return std::pair<Iterator, bool>(it, false);
+        }
+        Node* n = list.create(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+        return std::pair<Iterator, bool>(link(n), true);
+    }
+    /**
+     * Add a new node, which is not yet in the map, to the list and the tables
+     * @param n
+     * @return      iterator to the node
+     */
+    Iterator link(Node* n) {
+        if (tab1 == emptyTable() || list.head == nullptr) {
+            try {
+                if (tab1 == emptyTable()) allocateTables();
+                if (list.head == nullptr) list.createEnds();
+            } catch (...) {
+                list.destroy(n);
+                throw;
+            }
+        }
+        Node* stored_n = n;
         list.insert(n);
         ++map_size;
         for (int i = 0; i < 50; ++i) {
-            swap(n, tab1[getHash1(n->p.first)]);
+            std::swap(n, tab1[getHash1(n->p.first)]);
             if (n == nullptr) {
-                return std::pair<Iterator, bool>(Iterator(stored_n), true);
+                return Iterator(stored_n);
             }
-            swap(n, tab2[getHash2(n->p.first)]);
+            std::swap(n, tab2[getHash2(n->p.first)]);
             if (n == nullptr) {
-                return std::pair<Iterator, bool>(Iterator(stored_n), true);
+                return Iterator(stored_n);
             }
         }
         rehash();
-        return std::pair<Iterator, bool>(Iterator(stored_n), true);
+        return Iterator(stored_n);
     }
-    bool insert(Node<Key, Value>* n) {
+    bool insert(Node* n) {
         for (int i = 0; i < 100; i++) {
-            swap(n, tab1[getHash1(n->p.first)]);
+            std::swap(n, tab1[getHash1(n->p.first)]);
             if (n == nullptr) {
                 return true;
             }
-            swap(n, tab2[getHash2(n->p.first)]);
+            std::swap(n, tab2[getHash2(n->p.first)]);
             if (n == nullptr) {
                 return true;
             }
@@ -108,6 +296,10 @@ public:
         return false;
     }
     std::size_t erase(const Key & key) {
+        return erase<Key>(key);
+    }
+    template <class K> requires is_lookup_key<K>
+    std::size_t erase(const K & key) {
         Iterator it = find(key);
         if (it != end()) {
             erase(it);
@@ -117,14 +309,14 @@ public:
     }
     Iterator erase(const Iterator & it) {
         if (it.tmp == list.tail || it.tmp == list.head) return end();
-        Key key = it.tmp->p.first;
-        Node<Key, Value>* tmp = nullptr;
+        const Key & key = it.tmp->p.first;
+        Node* tmp = nullptr;
         std::size_t h1 = getHash1(key), h2 = getHash2(key);
-        if (tab1[h1] != nullptr && tab1[h1]->p.first == key) {
+        if (tab1[h1] == it.tmp) {
             tmp = tab1[h1]->next;
             list.erase(tab1[h1]);
             tab1[h1] = nullptr;
-        } else if (tab2[h2] != nullptr && tab2[h2]->p.first == key) {
+        } else if (tab2[h2] == it.tmp) {
             tmp = tab2[h2]->next;
             list.erase(tab2[h2]);
             tab2[h2] = nullptr;
@@ -139,9 +331,19 @@ public:
         return Iterator(list.tail);
     }
     Iterator begin() const {
-        return Iterator(list.head->next);
+        return Iterator(list.head != nullptr ? list.head->next : nullptr);
     }
     Iterator find(const Key& key) {
+        return find<Key>(key);
+    }
+    /**
+     * Find the key equal to key of another type, e.g. std::string_view
+     * or const char* for std::string keys, without constructing a Key
+     * @param key
+     * @return      iterator to the element or end()
+     */
+    template <class K> requires is_lookup_key<K>
+    Iterator find(const K & key) {
         std::size_t h1 = getHash1(key), h2 = getHash2(key);
         if (tab1[h1] != nullptr && tab1[h1]->p.first == key) {
             return Iterator(tab1[h1]);
@@ -150,59 +352,126 @@ public:
         }
         return end();
     }
+    /**
+     * Find all keys of the batch. The slots of both tables are prefetched
+     * for a group of keys, then the nodes they point to, and only then
+     * the keys are compared, so the memory accesses of the group overlap.
+     * @param keys
+     * @param out       iterator for each key, end() for absent keys
+     */
+    void find_batch(std::span<const Key> keys, std::span<Iterator> out) {
+        constexpr std::size_t GROUP = 16;
+        std::size_t h1[GROUP], h2[GROUP];
+        for (std::size_t start = 0; start < keys.size(); start += GROUP) {
+            std::size_t len = std::min(GROUP, keys.size() - start);
+            for (std::size_t i = 0; i < len; ++i) {
+                h1[i] = getHash1(keys[start + i]);
+                h2[i] = getHash2(keys[start + i]);
+                __builtin_prefetch(&tab1[h1[i]]);
+                __builtin_prefetch(&tab2[h2[i]]);
+            }
+            for (std::size_t i = 0; i < len; ++i) {
+                if (tab1[h1[i]] != nullptr) __builtin_prefetch(tab1[h1[i]]);
+                if (tab2[h2[i]] != nullptr) __builtin_prefetch(tab2[h2[i]]);
+            }
+            for (std::size_t i = 0; i < len; ++i) {
+                const Key & key = keys[start + i];
+                if (tab1[h1[i]] != nullptr && tab1[h1[i]]->p.first == key) {
+                    out[start + i] = Iterator(tab1[h1[i]]);
+                } else if (tab2[h2[i]] != nullptr && tab2[h2[i]]->p.first == key) {
+                    out[start + i] = Iterator(tab2[h2[i]]);
+                } else {
+                    out[start + i] = end();
+                }
+            }
+        }
+    }
+    /**
+     * Insert all pairs of the batch, prefetching the slots of a group
+     * of keys before inserting them one by one
+     * @param pairs
+     * @return          number of inserted keys
+     */
+    std::size_t insert_batch(std::span<const std::pair<Key, Value>> pairs) {
+        constexpr std::size_t GROUP = 16;
+        std::size_t inserted = 0;
+        for (std::size_t start = 0; start < pairs.size(); start += GROUP) {
+            std::size_t len = std::min(GROUP, pairs.size() - start);
+            for (std::size_t i = 0; i < len; ++i) {
+                __builtin_prefetch(&tab1[getHash1(pairs[start + i].first)]);
+                __builtin_prefetch(&tab2[getHash2(pairs[start + i].first)]);
+            }
+            for (std::size_t i = 0; i < len; ++i) {
+                inserted += insert(pairs[start + i]).second;
+            }
+        }
+        return inserted;
+    }
     std::size_t size() {
         return (std::size_t) map_size;
     }
     void rehash() {
-        capacity *= 2;
-        delete[] tab1; delete[] tab2;
-        tab1 = new Node<Key, Value>*[capacity];
-        tab2 = new Node<Key, Value>*[capacity];
-        std::fill_n(tab1, capacity, nullptr);
-        std::fill_n(tab2, capacity, nullptr);
-        bool luckily_done = true;
-        Node<Key, Value>* tmp = list.head->next;
-        while (tmp != list.tail && luckily_done) {
-            luckily_done = insert(tmp);
-            tmp = tmp->next;
-        }
-        if (!luckily_done) {
-            rehash();
+        ++rehash_count;
+        bool luckily_done = false, grow = true;
+        while (!luckily_done) {
+            if (grow) {
+                capacity *= 2;
+                --shift;
+            } else {
+                seed = hashing::splitmix(seed);
+                hash1 = Hash1(seed);
+                hash2 = Hash2(seed + 1);
+            }
+            freeTables();
+            allocateTables();
+            luckily_done = true;
+            Node* tmp = list.head->next;
+            while (tmp != list.tail && luckily_done) {
+                luckily_done = insert(tmp);
+                tmp = tmp->next;
+            }
+            grow = !seeded;
         }
     }
     void clear() {
         list.clearList();
-        delete[] tab1; delete[] tab2;
-        capacity = 120; map_size = 0;
-        tab1 = new Node<Key, Value>*[capacity];
-        tab2 = new Node<Key, Value>*[capacity];
-        std::fill_n(tab1, capacity, nullptr);
-        std::fill_n(tab2, capacity, nullptr);
+        freeTables();
+        capacity = 128; map_size = 0;
+        shift = 64 - std::countr_zero(128u);
+        tab1 = tab2 = emptyTable();
     }
     Value& operator[](const Key & key) {
-        Iterator it = find(key);
-        if(it == end()) {
-            std::pair<Key, Value> p;
-            p.first = key;
-            it = insert(p).first;
-        }
-        return it->second;
+        return try_emplace(key).first->second;
+    }
+    Value& operator[](Key && key) {
+        return try_emplace(std::move(key)).first->second;
+    }
+    template <class K>
+        requires (!std::is_same_v<std::remove_cvref_t<K>, Key> && is_lookup_key<std::remove_cvref_t<K>>)
+    Value& operator[](K && key) {
+        return try_emplace(std::forward<K>(key)).first->second;
     }
 };
 
-template <class Key, class Value>
-class UnorderedMap<Key, Value>::LinkedList
+template <class Key, class Value, class Hash1, class Hash2, class Allocator>
+class UnorderedMap<Key, Value, Hash1, Hash2, Allocator>::LinkedList
 {
+    using Traits = std::allocator_traits<NodeAllocator>;
+
 public:
-    Node<Key, Value>* head;
-    Node<Key, Value>* tail;
+    Node* head;
+    Node* tail;
+    NodeAllocator alloc;
 
-    LinkedList() {
-        head = new Node<Key, Value>;
-        tail = new Node<Key, Value>;
-        head->next = tail;
-        tail->prev = head;
-        head->prev = tail->next = nullptr;
+    explicit LinkedList(const NodeAllocator & _alloc) : alloc(_alloc) {
+        createEnds();
+    }
+    /**
+     * Take the nodes of l, which keeps a copy of the allocator
+     * and no ends until its next insertion
+     */
+    LinkedList(LinkedList && l) noexcept : head(l.head), tail(l.tail), alloc(l.alloc) {
+        l.head = l.tail = nullptr;
     }
     ~LinkedList() {
         clearList();
@@ -210,37 +479,77 @@ public:
         delete tail;
     }
 
-    void insert(Node<Key, Value>* n) {
+    void createEnds() {
+        auto new_head = std::make_unique<Node>();
+        tail = new Node;
+        head = new_head.release();
+        head->next = tail;
+        tail->prev = head;
+        head->prev = tail->next = nullptr;
+    }
+    void insert(Node* n) {
         tail->prev->next = n;
         n->prev = tail->prev;
         tail->prev = n;
         n->next = tail;
     }
-    void erase(Node<Key, Value>* n) {
+    template <class... Args>
+    Node* create(Args&&... args) {
+        Node* n = Traits::allocate(alloc, 1);
+        try {
+            Traits::construct(alloc, n, std::in_place, std::forward<Args>(args)...);
+        } catch (...) {
+            Traits::deallocate(alloc, n, 1);
+            throw;
+        }
+        return n;
+    }
+    void destroy(Node* n) {
+        Traits::destroy(alloc, n);
+        Traits::deallocate(alloc, n, 1);
+    }
+    void erase(Node* n) {
         n->prev->next = n->next;
         n->next->prev = n->prev;
-        n->next = n->prev = nullptr;
-        delete n;
+        destroy(n);
     }
+    /**
+     * Remove all nodes. If the list is the only user of its allocator's
+     * resource, the slabs are released at once instead of freeing
+     * the nodes one by one, and trivially destructible nodes
+     * are not even visited.
+     */
     void clearList() {
-        Node<Key, Value>* tmp = head->next;
-        while (tmp->next != nullptr) {
-            head->next = tmp->next;
-            delete tmp;
-            tmp = head->next;
+        if (head == nullptr) {
+            return;
+        }
+        bool bulk = memory::ownsResource(alloc);
+        if (!bulk || !std::is_trivially_destructible_v<Node>) {
+            Node* tmp = head->next;
+            while (tmp->next != nullptr) {
+                head->next = tmp->next;
+                Traits::destroy(alloc, tmp);
+                if (!bulk) {
+                    Traits::deallocate(alloc, tmp, 1);
+                }
+                tmp = head->next;
+            }
+        }
+        if (bulk) {
+            memory::release(alloc);
         }
         head->next = tail;
         tail->prev = head;
     }
 };
 
-template <class Key, class Value>
-class UnorderedMap<Key, Value>::Iterator
+template <class Key, class Value, class Hash1, class Hash2, class Allocator>
+class UnorderedMap<Key, Value, Hash1, Hash2, Allocator>::Iterator
 {
 public:
-    Node<Key, Value>* tmp = nullptr;
+    Node* tmp = nullptr;
     Iterator() = default;
-    explicit Iterator(Node<Key, Value>* _tmp) {
+    explicit Iterator(Node* _tmp) {
         tmp = _tmp;
     }
 
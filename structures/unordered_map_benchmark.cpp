@@ -0,0 +1,216 @@
+#include "unordered_map.hpp"
+#include "flat_unordered_map.hpp"
+#include "concurrent_unordered_map.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<std::uint64_t> make_keys(const std::string & pattern, int n) {
+    std::vector<std::uint64_t> keys(n);
+    std::mt19937_64 gen(2024);
+    for (int i = 0; i < n; i++) {
+        if (pattern == "sequential") {
+            keys[i] = i;
+        } else if (pattern == "random") {
+            keys[i] = gen();
+        } else {
+            keys[i] = static_cast<std::uint64_t>(i) << 12;
+        }
+    }
+    return keys;
+}
+
+/**
+ * Rehash frequency of the cuckoo maps with different hashers
+ * for sequential, random and strided integer keys
+ */
+void bench_hashers(int n) {
+    using K = std::uint64_t;
+    std::cout << "Rehashes for " << n << " insertions" << std::endl;
+    for (std::string pattern : {"sequential", "random", "strided"}) {
+        std::cout << pattern << " keys" << std::endl;
+        auto keys = make_keys(pattern, n);
+        auto run = [&](const std::string & name, auto map) {
+            auto start = Clock::now();
+            for (auto key : keys) {
+                map[key] = 1;
+            }
+            double ms = elapsed_ms(start);
+            std::size_t rehashes;
+            if constexpr (requires { map.rehashes(); }) {
+                rehashes = map.rehashes();
+            } else {
+                rehashes = map.rehash_count;
+            }
+            std::cout << "  " << name << ": " << rehashes << " rehashes, " << ms << " ms" << std::endl;
+        };
+        run("UnorderedMap<multiply-shift, wyhash>", UnorderedMap<K, int>());
+        run("UnorderedMap<wyhash, wyhash>", UnorderedMap<K, int, WyHash<K>, WyHash<K>>());
+        run("UnorderedMap<multiply-shift, multiply-shift>",
+            UnorderedMap<K, int, MultiplyShiftHash<K>, MultiplyShiftHash<K>>());
+        run("UnorderedMap seeded", UnorderedMap<K, int>(std::random_device()()));
+        run("FlatUnorderedMap", FlatUnorderedMap<K, int>());
+        run("FlatUnorderedMap seeded", FlatUnorderedMap<K, int>(std::random_device()()));
+        run("FlatUnorderedMap 4-way", FlatUnorderedMap<K, int, 4>());
+    }
+}
+
+/**
+ * Print percentiles and a log2 histogram of insertion latencies
+ */
+void print_latencies(const std::string & name, std::vector<double> ns) {
+    std::sort(ns.begin(), ns.end());
+    auto at = [&](double q) {
+        return ns[std::min(ns.size() - 1, static_cast<std::size_t>(q * static_cast<double>(ns.size())))];
+    };
+    std::cout << "  " << name << ": p50 " << at(0.5) << " ns, p99 " << at(0.99) << " ns, p99.9 " << at(0.999)
+              << " ns, p99.99 " << at(0.9999) << " ns, max " << ns.back() / 1e6 << " ms" << std::endl;
+    std::vector<int> histogram(64);
+    for (double x : ns) {
+        histogram[std::bit_width(static_cast<std::uint64_t>(x))]++;
+    }
+    for (int i = 0; i < 64; i++) {
+        if (histogram[i] > 0) {
+            std::cout << "    < " << (1ull << i) << " ns: " << histogram[i] << std::endl;
+        }
+    }
+}
+
+/**
+ * Latency of single insertions into a growing map
+ * with the stop-the-world and the incremental rehash
+ */
+void bench_insert_latency(int n) {
+    using K = std::uint64_t;
+    std::cout << "Insertion latency for " << n << " random keys" << std::endl;
+    auto keys = make_keys("random", n);
+    auto run = [&](const std::string & name, std::size_t step) {
+        FlatUnorderedMap<K, int, 4> map;
+        map.set_incremental(step);
+        std::vector<double> ns(n);
+        for (int i = 0; i < n; i++) {
+            auto start = Clock::now();
+            map.insert({keys[i], i});
+            ns[i] = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        }
+        print_latencies(name, ns);
+    };
+    run("stop-the-world rehash", 0);
+    run("incremental rehash, 8 entries per operation", 8);
+}
+
+/**
+ * Throughput of the concurrent map for 1 to max_threads threads
+ * performing a mix of lookups and insertions over a prefilled map
+ */
+void bench_concurrent(int n, int max_threads) {
+    using K = std::uint64_t;
+    std::cout << "Concurrent map throughput, " << n << " operations per thread" << std::endl;
+    auto keys = make_keys("random", n);
+    for (int reads : {50, 90, 99}) {
+        for (int threads = 1; threads <= max_threads; threads *= 2) {
+            ConcurrentUnorderedMap<K, K> map;
+            for (int i = 0; i < n / 2; i++) {
+                map.insert(keys[i], i);
+            }
+            std::vector<std::thread> workers;
+            std::atomic<std::size_t> found_total{0};
+            auto start = Clock::now();
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&, t]() {
+                    std::mt19937_64 gen(t);
+                    std::size_t found = 0;
+                    for (int i = 0; i < n; i++) {
+                        K key = keys[gen() % n];
+                        if (static_cast<int>(gen() % 100) < reads) {
+                            found += map.find(key).has_value();
+                        } else {
+                            map.insert(key, i);
+                        }
+                    }
+                    found_total += found;
+                });
+            }
+            for (auto & worker : workers) {
+                worker.join();
+            }
+            double ms = elapsed_ms(start);
+            std::cout << "  " << reads << "% reads, " << threads << " threads: "
+                      << static_cast<double>(n) * threads / ms / 1000 << " Mops/s (" << found_total
+                      << " found)" << std::endl;
+        }
+    }
+}
+
+/**
+ * Lookups of random present keys one by one and in batches,
+ * for maps larger than the last level cache
+ */
+void bench_batch_lookup(int n) {
+    using K = std::uint64_t;
+    std::cout << "Lookups of " << n << " keys in a map of " << n << " entries" << std::endl;
+    auto keys = make_keys("random", n);
+    std::vector<std::pair<K, K>> pairs;
+    for (int i = 0; i < n; i++) {
+        pairs.push_back({keys[i], i});
+    }
+    std::vector<K> queries(n);
+    std::mt19937_64 gen(1);
+    for (auto & q : queries) {
+        q = keys[gen() % n];
+    }
+    auto run = [&](const std::string & name, auto & map) {
+        using Iterator = typename std::remove_reference_t<decltype(map)>::Iterator;
+        map.insert_batch(pairs);
+        K sum = 0;
+        auto start = Clock::now();
+        for (auto q : queries) {
+            sum += map.find(q)->second;
+        }
+        double single_ms = elapsed_ms(start);
+        constexpr std::size_t BATCH = 256;
+        std::vector<Iterator> out(BATCH);
+        start = Clock::now();
+        for (std::size_t i = 0; i < queries.size(); i += BATCH) {
+            std::size_t len = std::min(BATCH, queries.size() - i);
+            map.find_batch(std::span<const K>(queries).subspan(i, len), out);
+            for (std::size_t j = 0; j < len; j++) {
+                sum -= out[j]->second;
+            }
+        }
+        double batch_ms = elapsed_ms(start);
+        std::cout << "  " << name << ": find " << single_ms << " ms, find_batch " << batch_ms << " ms"
+                  << (sum == 0 ? "" : " (mismatch)") << std::endl;
+    };
+    UnorderedMap<K, K> map;
+    run("UnorderedMap", map);
+    FlatUnorderedMap<K, K> flat_map;
+    run("FlatUnorderedMap", flat_map);
+    FlatUnorderedMap<K, K, 4> bucket_map;
+    run("FlatUnorderedMap 4-way", bucket_map);
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    bench_hashers(n);
+    bench_insert_latency(n);
+    int threads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::max(4u, std::thread::hardware_concurrency()));
+    bench_concurrent(n, threads);
+    bench_batch_lookup(4 * n);
+    return 0;
+}
@@ -0,0 +1,474 @@
+/**
+ * Unrolled variant of DoubleList: every node is a block holding up to
+ * Capacity elements in a contiguous array, so iteration and pushes at
+ * the ends touch memory sequentially instead of one node per element.
+ * The blocks are linked the same way as the nodes of DoubleList, by two
+ * links without a fixed direction, so reverse and merge stay O(1).
+ * The order of the elements inside a block is relative to its links:
+ * a block's reversed bit tells whether its array runs towards the
+ * neighbor in next[0] or next[1], and reversing the list, which only
+ * swaps the ends, reverses the blocks as they are traversed from the
+ * other side. Blocks are allocated with Allocator rebound to the block.
+ */
+
+#ifndef ALGORITHMS_UNROLLED_DOUBLE_LIST_HPP
+#define ALGORITHMS_UNROLLED_DOUBLE_LIST_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "memory_pool.hpp"
+
+template <class T, class Allocator = std::allocator<T>,
+          std::size_t Capacity = std::max<std::size_t>(4, 512 / sizeof(T))>
+class UnrolledDoubleList {
+    static_assert(Capacity > 0 && Capacity <= 0xFFFF, "A block holds 1 to 65535 elements");
+
+    struct Link {
+        Link* next[2];
+    };
+
+    /**
+     * The elements are in data()[lo, hi); the array runs towards next[1],
+     * or towards next[0] if the block is reversed
+     */
+    struct Block : Link {
+        std::uint16_t lo = 0, hi = 0;
+        bool reversed = false;
+        alignas(T) unsigned char storage[Capacity * sizeof(T)];
+
+        T* data() {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+    using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+    using Traits = std::allocator_traits<BlockAllocator>;
+    BlockAllocator block_alloc;
+    Link* head;
+    Link* tail;
+    std::size_t count = 0;
+
+    static Block* block(Link* link) {
+        return static_cast<Block*>(link);
+    }
+
+    /**
+     * @return      whether the array of b runs towards its neighbor in slot s
+     */
+    static bool runsTowards(const Block* b, int s) {
+        return s == (b->reversed ? 0 : 1);
+    }
+
+    /**
+     * @return      slot of b which holds the neighbor
+     */
+    static int slotOf(const Link* b, const Link* neighbor) {
+        return b->next[1] == neighbor ? 1 : 0;
+    }
+
+    /**
+     * @return      the first block or nullptr if the list is empty
+     */
+    Block* firstBlock() const {
+        Link* first = head->next[head->next[0] == tail];
+        return first == tail ? nullptr : block(first);
+    }
+
+    Block* lastBlock() const {
+        Link* last = tail->next[tail->next[0] == head];
+        return last == head ? nullptr : block(last);
+    }
+
+    /**
+     * Allocate a block holding one element constructed from args
+     * at position at of its array
+     */
+    template <class... Args>
+    Block* createBlock(std::uint16_t at, Args&&... args) {
+        Block* b = Traits::allocate(block_alloc, 1);
+        ::new (static_cast<void*>(b)) Block;
+        try {
+            ::new (static_cast<void*>(b->data() + at)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            Traits::deallocate(block_alloc, b, 1);
+            throw;
+        }
+        b->lo = at;
+        b->hi = at + 1;
+        return b;
+    }
+
+    void destroyBlock(Block* b) {
+        std::destroy(b->data() + b->lo, b->data() + b->hi);
+        Traits::deallocate(block_alloc, b, 1);
+    }
+
+    /**
+     * Construct an element at the end of b facing its neighbor in slot s
+     * @return      false if the array of b is full at that end
+     */
+    template <class... Args>
+    bool emplaceAt(Block* b, int s, Args&&... args) {
+        if (runsTowards(b, s)) {
+            if (b->hi == Capacity) return false;
+            ::new (static_cast<void*>(b->data() + b->hi)) T(std::forward<Args>(args)...);
+            ++b->hi;
+        } else {
+            if (b->lo == 0) return false;
+            ::new (static_cast<void*>(b->data() + b->lo - 1)) T(std::forward<Args>(args)...);
+            --b->lo;
+        }
+        return true;
+    }
+
+    /**
+     * Remove the element at the end of b facing its neighbor in slot s
+     */
+    T takeAt(Block* b, int s) {
+        T* x = runsTowards(b, s) ? b->data() + b->hi - 1 : b->data() + b->lo;
+        T result = std::move(*x);
+        std::destroy_at(x);
+        if (runsTowards(b, s)) --b->hi; else ++b->lo;
+        return result;
+    }
+
+    /**
+     * Link the block as the first one, as DoubleList::push_front does
+     */
+    void linkFront(Link* node) {
+        bool dir_head = (head->next[0] == tail);
+        bool dir_sec = (head->next[dir_head]->next[1] == head);
+        node->next[dir_head] = head->next[dir_head];
+        node->next[dir_head]->next[dir_sec] = node;
+        node->next[1-dir_head] = head;
+        head->next[dir_head] = node;
+    }
+
+    void linkBack(Link* node) {
+        bool dir_tail = (tail->next[0] == head);
+        bool dir_last = (tail->next[dir_tail]->next[1] == tail);
+        node->next[dir_tail] = tail->next[dir_tail];
+        node->next[dir_tail]->next[dir_last] = node;
+        node->next[1-dir_tail] = tail;
+        tail->next[dir_tail] = node;
+    }
+
+    /**
+     * Unlink the first or the last block, which is next to the sentinel end
+     * on the side of the sentinel other
+     */
+    static void unlink(Link* end, Link* other) {
+        bool dir_end = (end->next[0] == other);
+        bool dir_n = (end->next[dir_end]->next[0] == end);
+        bool dir_after_n = (end->next[dir_end]->next[dir_n]->next[1] == end->next[dir_end]);
+        Link* node = end->next[dir_end];
+        end->next[dir_end] = node->next[dir_n];
+        node->next[dir_n]->next[dir_after_n] = end;
+    }
+
+    void reset() {
+        head->next[0] = tail;
+        head->next[1] = tail;
+        tail->next[0] = head;
+        tail->next[1] = head;
+        count = 0;
+    }
+
+public:
+    explicit UnrolledDoubleList(const Allocator & alloc = Allocator())
+        : block_alloc(alloc), head(new Link()), tail(new Link()) {
+        reset();
+    }
+    UnrolledDoubleList(const UnrolledDoubleList &) = delete;
+    UnrolledDoubleList& operator=(const UnrolledDoubleList &) = delete;
+    /**
+     * Take the blocks of L, which is left empty with a fresh allocator
+     * @param L
+     */
+    UnrolledDoubleList(UnrolledDoubleList && L)
+        : UnrolledDoubleList(Traits::select_on_container_copy_construction(L.block_alloc)) {
+        swap(L);
+    }
+    UnrolledDoubleList& operator=(UnrolledDoubleList && L) noexcept {
+        swap(L);
+        return *this;
+    }
+    void swap(UnrolledDoubleList & L) noexcept {
+        std::swap(block_alloc, L.block_alloc);
+        std::swap(head, L.head);
+        std::swap(tail, L.tail);
+        std::swap(count, L.count);
+    }
+    ~UnrolledDoubleList() {
+        clear();
+        delete head;
+        delete tail;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    /**
+     * Add element constructed from args to the beginning of the list,
+     * in the first block if it has room at that end
+     * @param args      arguments of the T constructor
+     */
+    template <class... Args>
+    void emplace_front(Args&&... args) {
+        Block* b = firstBlock();
+        if (!b || !emplaceAt(b, slotOf(b, head), std::forward<Args>(args)...)) {
+            // the array of a new first block runs away from the head and fills from its end
+            b = createBlock(Capacity - 1, std::forward<Args>(args)...);
+            linkFront(b);
+            b->reversed = slotOf(b, head) == 1;
+        }
+        ++count;
+    }
+
+    void push_front(const T & name) {
+        emplace_front(name);
+    }
+
+    void push_front(T && name) {
+        emplace_front(std::move(name));
+    }
+
+    /**
+     * Add element constructed from args to the end of the list,
+     * in the last block if it has room at that end
+     * @param args      arguments of the T constructor
+     */
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        Block* b = lastBlock();
+        if (!b || !emplaceAt(b, slotOf(b, tail), std::forward<Args>(args)...)) {
+            // the array of a new last block runs towards the tail and fills from its beginning
+            b = createBlock(0, std::forward<Args>(args)...);
+            linkBack(b);
+            b->reversed = slotOf(b, tail) == 0;
+        }
+        ++count;
+    }
+
+    void push_back(const T & name) {
+        emplace_back(name);
+    }
+
+    void push_back(T && name) {
+        emplace_back(std::move(name));
+    }
+
+    T & front() {
+        if (empty()) throw std::out_of_range("List is empty");
+        Block* b = firstBlock();
+        return runsTowards(b, slotOf(b, head)) ? b->data()[b->hi - 1] : b->data()[b->lo];
+    }
+
+    T & back() {
+        if (empty()) throw std::out_of_range("List is empty");
+        Block* b = lastBlock();
+        return runsTowards(b, slotOf(b, tail)) ? b->data()[b->hi - 1] : b->data()[b->lo];
+    }
+
+    /**
+     * Remove the first element from the list
+     * @return      the element
+     */
+    T pop_front() {
+        if (empty()) throw std::out_of_range("List is empty");
+        Block* b = firstBlock();
+        T result = takeAt(b, slotOf(b, head));
+        if (b->lo == b->hi) {
+            unlink(head, tail);
+            destroyBlock(b);
+        }
+        --count;
+        return result;
+    }
+
+    /**
+     * Remove the last element from the list
+     * @return      the element
+     */
+    T pop_back() {
+        if (empty()) throw std::out_of_range("List is empty");
+        Block* b = lastBlock();
+        T result = takeAt(b, slotOf(b, tail));
+        if (b->lo == b->hi) {
+            unlink(tail, head);
+            destroyBlock(b);
+        }
+        --count;
+        return result;
+    }
+
+    /**
+     *  Reverse the order of elements in the list, as DoubleList::reverse
+     */
+    void reverse() {
+        if (empty()) return;
+        bool dir_head = (head->next[0] == tail);
+        bool dir_tail = (tail->next[0] == head);
+        bool dir_sec = (head->next[dir_head]->next[1] == head);
+        bool dir_last = (tail->next[dir_tail]->next[1] == tail);
+        head->next[1-dir_head] = tail->next[dir_tail];
+        tail->next[1-dir_tail] = head->next[dir_head];
+        head->next[dir_head] = tail;
+        tail->next[dir_tail] = head;
+        tail->next[1-dir_tail]->next[dir_sec] = tail;
+        head->next[1-dir_head]->next[dir_last] = head;
+    }
+
+    /**
+     * Add all elements of list L to the end of this list by linking its
+     * blocks. After the operation, L becomes empty.
+     * If the allocators of the lists differ, the blocks cannot be relinked
+     * and the elements are moved one by one instead
+     * @param L
+     */
+    void merge(UnrolledDoubleList& L) {
+        if (L.empty()) return;
+        if (!(block_alloc == L.block_alloc)) {
+            while (!L.empty()) {
+                push_back(L.pop_front());
+            }
+            return;
+        }
+        bool dir_tail = (tail->next[0] == head);
+        bool dir_last = (tail->next[dir_tail]->next[1] == tail);
+        bool dir_head_L = (L.head->next[0] == L.tail);
+        bool dir_sec_L = (L.head->next[dir_head_L]->next[1] == L.head);
+        bool dir_tail_L = (L.tail->next[0] == L.head);
+        bool dir_last_L = (L.tail->next[dir_tail_L]->next[1] == L.tail);
+
+        tail->next[dir_tail]->next[dir_last] = L.head->next[dir_head_L];
+        L.head->next[dir_head_L]->next[dir_sec_L] = tail->next[dir_tail];
+        L.tail->next[dir_tail_L]->next[dir_last_L] = tail;
+        tail->next[0] = L.tail->next[dir_tail_L];
+        tail->next[1] = head;
+        count += L.count;
+        L.reset();
+    }
+
+    /**
+     * Remove elements from the list. If the list is the only user of its
+     * allocator's resource, the slabs are released at once, and blocks
+     * of trivially destructible elements are not even visited
+     */
+    void clear() {
+        if (empty()) return;
+        bool bulk = memory::ownsResource(block_alloc);
+        if (!bulk || !std::is_trivially_destructible_v<T>) {
+            Link* prev = head;
+            for (Link* cur = head->next[head->next[0] == tail]; cur != tail; ) {
+                Link* next = cur->next[cur->next[0] == prev];
+                prev = cur;
+                if (bulk) {
+                    std::destroy(block(cur)->data() + block(cur)->lo, block(cur)->data() + block(cur)->hi);
+                } else {
+                    destroyBlock(block(cur));
+                }
+                cur = next;
+            }
+        }
+        if (bulk) {
+            memory::release(block_alloc);
+        }
+        reset();
+    }
+
+    /**
+     * Forward iterator walking the array of every block in the direction
+     * in which the block is traversed
+     */
+    class Iterator {
+        const Link* current = nullptr;
+        const Link* prev = nullptr;
+        T* data = nullptr;
+        std::ptrdiff_t index = 0, stop = 0, step = 1;
+        const Link* end_link = nullptr;
+
+        void enter() {
+            if (current == end_link) {
+                index = 0;
+                return;
+            }
+            Block* b = block(const_cast<Link*>(current));
+            data = b->data();
+            if (runsTowards(b, slotOf(b, prev))) {
+                index = b->hi - 1;
+                stop = b->lo - 1;
+                step = -1;
+            } else {
+                index = b->lo;
+                stop = b->hi;
+                step = 1;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        Iterator() = default;
+        Iterator(const Link* _current, const Link* _prev, const Link* _end)
+            : current(_current), prev(_prev), end_link(_end) {
+            enter();
+        }
+
+        T & operator*() const {
+            return data[index];
+        }
+
+        Iterator & operator++() {
+            index += step;
+            if (index == stop) {
+                bool dir = (current->next[0] == prev);
+                prev = current;
+                current = current->next[dir];
+                enter();
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator &other) const {
+            return current == other.current && index == other.index;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return !(*this == other);
+        }
+    };
+
+    Iterator begin() const {
+        bool dir = (head->next[0] == tail);
+        return Iterator(head->next[dir], head, tail);
+    }
+
+    Iterator end() const {
+        return Iterator(tail, nullptr, tail);
+    }
+};
+
+#endif //ALGORITHMS_UNROLLED_DOUBLE_LIST_HPP
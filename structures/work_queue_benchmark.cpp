@@ -0,0 +1,125 @@
+#include "double_linked_list.hpp"
+#include "mpsc_queue.hpp"
+#include "spsc_ring_buffer.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * DoubleList behind a single mutex, the baseline work queue
+ */
+class LockedList {
+    std::mutex mutex;
+    DoubleList<std::uint64_t> list;
+
+public:
+    void push_back(std::uint64_t x) {
+        std::lock_guard<std::mutex> lock(mutex);
+        list.push_back(x);
+    }
+    bool try_pop_front(std::uint64_t & x) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Node<std::uint64_t>* node = list.pop_front();
+        if (node == nullptr) {
+            return false;
+        }
+        x = node->name;
+        list.destroy(node);
+        return true;
+    }
+};
+
+class Spsc {
+    SpscRingBuffer<std::uint64_t> ring{4096};
+
+public:
+    void push_back(std::uint64_t x) {
+        ring.push_back(x);
+    }
+    bool try_pop_front(std::uint64_t & x) {
+        auto value = ring.pop_front();
+        if (!value) {
+            return false;
+        }
+        x = *value;
+        return true;
+    }
+};
+
+class Mpsc {
+    MpscQueue<std::uint64_t> queue;
+
+public:
+    void push_back(std::uint64_t x) {
+        queue.push_back(x);
+    }
+    bool try_pop_front(std::uint64_t & x) {
+        Node<std::uint64_t>* node = queue.pop_front();
+        if (node == nullptr) {
+            return false;
+        }
+        x = node->name;
+        queue.destroy(node);
+        return true;
+    }
+};
+
+/**
+ * Producers push n elements in total while one consumer pops them all;
+ * the consumer yields whenever it finds the queue empty
+ */
+template <class Queue>
+void bench(const std::string & name, std::size_t n, int producers) {
+    Queue queue;
+    std::uint64_t checksum = 0;
+    auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < producers; t++) {
+        workers.emplace_back([&queue, t, n, producers]() {
+            for (std::size_t i = t; i < n; i += producers) {
+                queue.push_back(i);
+            }
+        });
+    }
+    for (std::size_t popped = 0; popped < n; ) {
+        std::uint64_t x;
+        if (queue.try_pop_front(x)) {
+            checksum += x;
+            popped++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto & w : workers) {
+        w.join();
+    }
+    double ms = elapsed_ms(start);
+    std::cout << "  " << name << ": " << ms << " ms, " << n / ms / 1e3 << " M elements/s (checksum "
+              << checksum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    std::cout << n << " elements, 1 producer, 1 consumer" << std::endl;
+    bench<LockedList>("DoubleList + mutex", n, 1);
+    bench<Spsc>("SpscRingBuffer", n, 1);
+    bench<Mpsc>("MpscQueue", n, 1);
+    for (int producers : {2, 4}) {
+        std::cout << n << " elements, " << producers << " producers, 1 consumer" << std::endl;
+        bench<LockedList>("DoubleList + mutex", n, producers);
+        bench<Mpsc>("MpscQueue", n, producers);
+    }
+    return 0;
+}
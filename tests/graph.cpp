@@ -1,6 +1,8 @@
+#include "../graph/csr_graph.hpp"
 #include "../graph/dwyer.hpp"
 #include "../graph/edmonds_karp.hpp"
 #include "../graph/floyd_warshall.hpp"
+#include "../graph/graph_loader.hpp"
 #include "../graph/bipartite.hpp"
 #include "../graph/turbo_matching.hpp"
 #include "../graph/bellman_ford.hpp"
@@ -14,6 +16,13 @@
 #include <vector>
 #include <climits>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
 #include <tuple>
 
 void test_dwyer() {
@@ -81,6 +90,7 @@ void test_bipartite() {
             {0, 1}
     };
     assert(is_bipartite(graph0) == false);
+    assert(is_bipartite(CsrGraph(graph0)) == false);
     std::vector<std::vector<int>> graph1 = {
             {1, 2},
             {0, 3},
@@ -88,6 +98,7 @@ void test_bipartite() {
             {1}
     };
     assert(is_bipartite(graph1) == true);
+    assert(is_bipartite(CsrGraph(graph1)) == true);
     std::cout << "Bipartite test: OK" << std::endl;
 }
 
@@ -101,6 +112,7 @@ void test_turbo_matching() {
             {2, 3},
             {1, 2, 3}
     };
+    assert(find_match(CsrGraph(adj)) == 3);
     assert(find_match(adj) == 3);
     std::cout << "Turbo matching test: OK" << std::endl;
 }
@@ -116,6 +128,9 @@ void test_bellman_ford() {
     std::vector<int> dist0, dist0_ok = {0, -1, 2, -2, 1};
     bellman_ford(0, adj0, dist0);
     assert(dist0_ok == dist0);
+    dist0.clear();
+    assert(!bellman_ford(0, CsrGraph(adj0), dist0));
+    assert(dist0_ok == dist0);
 
     // Negative weight cycle
     std::vector<std::vector<std::pair<int, int>>> adj1 = {
@@ -126,12 +141,13 @@ void test_bellman_ford() {
     };
     std::vector<int> dist1;
     assert(bellman_ford(0, adj1, dist1));
+    assert(bellman_ford(0, CsrGraph(adj1), dist1));
     std::cout << "Bellman-Ford test: OK" << std::endl;
 }
 
 void test_dijkstra() {
         std::vector<std::vector<std::pair<int, int>>> adj = {
-                {{1,1}, {4,10}},
+                {{1,1}, {2,10}},
                 {{0,4}, {2,2}},
                 {},
                 {{0,3}}
@@ -139,6 +155,9 @@ void test_dijkstra() {
         std::vector<int> dist, dist_ok = {0, 1, 3, INT_MAX};
         dijkstra(0, adj, dist);
         assert(dist_ok == dist);
+        dist.clear();
+        dijkstra(0, CsrGraph(adj), dist);
+        assert(dist_ok == dist);
 
     std::cout << "Dijkstra test: OK" << std::endl;
 }
@@ -181,6 +200,7 @@ void test_scc() {
     };
     std::vector<int> components0 = {0, 0, 0, 2, 1};
     assert(components0 == get_scc(5, adj0));
+    assert(components0 == get_scc(CsrGraph(adj0)));
 
     std::vector<std::vector<int>> adj1 = {
             {1},
@@ -190,6 +210,7 @@ void test_scc() {
     };
     std::vector<int> components1 = {0, 0, 0, 0};
     assert(components1 == get_scc(4, adj1));
+    assert(components1 == get_scc(CsrGraph(adj1)));
 
     std::cout << "Strongly connected components test: OK" << std::endl;
 }
@@ -212,6 +233,9 @@ void test_topological_sort() {
     };
     assert(toposort(sorted0, adj0) == true);
     assert(sorted_correct0 == sorted0);
+    sorted0.clear();
+    assert(toposort(sorted0, CsrGraph(adj0)) == true);
+    assert(sorted_correct0 == sorted0);
     std::vector<std::vector<int>> adj1 = {
             {1},
             {2},
@@ -219,9 +243,193 @@ void test_topological_sort() {
     };
     std::vector<std::vector<int>> sorted1;
     assert(toposort(sorted1, adj1) == false);
+    std::vector<std::vector<int>> sorted1_csr;
+    assert(toposort(sorted1_csr, CsrGraph(adj1)) == false);
+    assert(sorted1 == sorted1_csr);
     std::cout << "Topological sort test: OK" << std::endl;
 }
 
+void test_csr_graph() {
+    std::vector<CsrGraph::Edge> edges = {
+            {2, 0, 7},
+            {0, 1, 3},
+            {2, 1, -1},
+            {0, 2, 5},
+            {0, 1, 4}
+    };
+    CsrGraph g(4, edges);
+    assert(g.vertices() == 4 && g.edges() == 5 && g.weighted());
+    std::vector<int> arcs0(g.neighbors(0).begin(), g.neighbors(0).end());
+    std::vector<int> weights0(g.weights(0).begin(), g.weights(0).end());
+    assert(arcs0 == std::vector<int>({1, 2, 1}) && weights0 == std::vector<int>({3, 5, 4}));
+    assert(g.degree(1) == 0 && g.degree(2) == 2 && g.degree(3) == 0 && g.end(3) == 5);
+    CsrGraph rev = g.transpose();
+    std::vector<int> arcs1(rev.neighbors(1).begin(), rev.neighbors(1).end());
+    std::vector<int> weights1(rev.weights(1).begin(), rev.weights(1).end());
+    assert(rev.edges() == 5 && arcs1 == std::vector<int>({0, 0, 2}) && weights1 == std::vector<int>({3, 4, -1}));
+
+    CsrGraph unweighted(3, std::vector<std::pair<int, int>>{{0, 1}, {1, 2}});
+    assert(!unweighted.weighted() && unweighted.transpose().neighbors(2)[0] == 1);
+    bool thrown = false;
+    try {
+        std::vector<int> dist;
+        dijkstra(0, unweighted, dist);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        CsrGraph(2, std::vector<std::pair<int, int>>{{0, 2}});
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown && CsrGraph().vertices() == 0 && CsrGraph(5, std::vector<CsrGraph::Edge>()).degree(4) == 0);
+    auto rejects = [](auto build) {
+        try {
+            build();
+        } catch (const std::invalid_argument &) {
+            return true;
+        }
+        return false;
+    };
+    assert(rejects([] { CsrGraph(std::vector<std::vector<int>>{std::vector<int>{1}, std::vector<int>{2}}); }));
+    assert(rejects([] {
+        CsrGraph(std::vector<std::vector<std::pair<int, int>>>{std::vector<std::pair<int, int>>{{-1, 3}}});
+    }));
+    assert(rejects([] { CsrGraph(std::vector<std::uint64_t>{0, 1}, std::vector<int>{1}); }));
+    assert(!rejects([] { CsrGraph(std::vector<std::uint64_t>{0, 1, 1}, std::vector<int>{1}); }));
+
+    // random graphs, the overloads agree with the adjacency lists versions
+    std::mt19937 gen(24);
+    for (int round = 0; round < 50; round++) {
+        int n = 1 + static_cast<int>(gen() % 60), m = static_cast<int>(gen() % (3 * n));
+        std::vector<std::vector<std::pair<int, int>>> weighted(n);
+        std::vector<std::vector<int>> adj(n), dag(n), sym(n);
+        std::vector<CsrGraph::Edge> list;
+        for (int i = 0; i < m; i++) {
+            int u = static_cast<int>(gen() % n), v = static_cast<int>(gen() % n), w = static_cast<int>(gen() % 100);
+            weighted[u].emplace_back(v, w);
+            adj[u].push_back(v);
+            list.push_back({u, v, w});
+            if (u != v) {
+                dag[std::min(u, v)].push_back(std::max(u, v));
+                sym[u].push_back(v);
+                sym[v].push_back(u);
+            }
+        }
+        std::vector<int> dist, dist_csr;
+        dijkstra(0, weighted, dist);
+        dijkstra(0, CsrGraph(n, list), dist_csr);
+        assert(dist == dist_csr);
+        assert(get_scc(n, adj) == get_scc(CsrGraph(adj)));
+        std::vector<std::vector<int>> sorted, sorted_csr;
+        assert(toposort(sorted, dag) && toposort(sorted_csr, CsrGraph(dag)) && sorted == sorted_csr);
+        assert(is_bipartite(sym) == is_bipartite(CsrGraph(sym)));
+        assert(find_match(sym) == find_match(CsrGraph(sym)));
+    }
+    std::cout << "CSR graph test: OK" << std::endl;
+}
+
+bool same_graph(const CsrGraph & a, const CsrGraph & b) {
+    if (a.vertices() != b.vertices() || a.edges() != b.edges() || a.weighted() != b.weighted()) return false;
+    for (int u = 0; u < a.vertices(); u++) {
+        if (!std::equal(a.neighbors(u).begin(), a.neighbors(u).end(), b.neighbors(u).begin(), b.neighbors(u).end())) {
+            return false;
+        }
+        if (a.edges() > 0 && a.weighted() &&
+            !std::equal(a.weights(u).begin(), a.weights(u).end(), b.weights(u).begin(), b.weights(u).end())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_graph_loader() {
+    auto dir = std::filesystem::temp_directory_path();
+    std::string snap = (dir / "test_graph_loader.snap").string();
+    std::string dimacs = (dir / "test_graph_loader.gr").string();
+    std::string image = (dir / "test_graph_loader.bin").string();
+
+    // arcs sorted by target for every source, as the loaders return them
+    std::mt19937 gen(25);
+    int n = 500;
+    std::vector<std::vector<std::pair<int, int>>> adj(n);
+    std::ofstream snap_out(snap), dimacs_out(dimacs);
+    snap_out << "# Directed graph\n# FromNodeId\tToNodeId\n";
+    dimacs_out << "c shortest paths\np sp " << n << " 3000\n";
+    for (int i = 0; i < 3000; i++) {
+        int u = static_cast<int>(gen() % n), v = static_cast<int>(gen() % (n - 1)), w = static_cast<int>(gen() % 200) - 50;
+        adj[u].emplace_back(v, w);
+        snap_out << u << (i % 2 ? "\t" : " ") << v << (i % 3 ? "\n" : "\r\n");
+        dimacs_out << "a " << u + 1 << " " << v + 1 << " " << w << "\n";
+    }
+    adj[n - 2].emplace_back(n - 1, 7);
+    snap_out << "% last arc without newline\n" << n - 2 << " " << n - 1;
+    dimacs_out << "a " << n - 1 << " " << n << " 7";
+    snap_out.close();
+    dimacs_out.close();
+    std::vector<std::vector<int>> targets(n);
+    for (int u = 0; u < n; u++) {
+        std::sort(adj[u].begin(), adj[u].end());
+        for (auto [v, w] : adj[u]) targets[u].push_back(v);
+    }
+    CsrGraph expected_snap(targets), expected_dimacs(adj);
+
+    for (int threads : {1, 3, 8}) {
+        CsrGraph g = read_snap(snap, threads);
+        assert(!g.weighted() && same_graph(g, expected_snap));
+        CsrGraph h = read_dimacs(dimacs, threads);
+        assert(h.weighted() && same_graph(h, expected_dimacs));
+    }
+
+    read_dimacs(dimacs, 2).write(image);
+    CsrGraph mapped = CsrGraph::open(image);
+    assert(same_graph(mapped, expected_dimacs));
+    std::vector<int> dist, dist_mapped;
+    assert(bellman_ford(0, expected_dimacs, dist) == bellman_ford(0, mapped, dist_mapped) && dist == dist_mapped);
+    CsrGraph moved = std::move(mapped);
+    assert(same_graph(moved, expected_dimacs) && mapped.vertices() == 0);
+    expected_snap.write(image);
+    assert(same_graph(CsrGraph::open(image), expected_snap));
+    CsrGraph().write(image);
+    assert(CsrGraph::open(image).vertices() == 0);
+
+    auto throws = [](auto f) {
+        try {
+            f();
+        } catch (const std::runtime_error &) {
+            return true;
+        }
+        return false;
+    };
+    std::ofstream(snap) << "0 1\n1 x\n";
+    std::ofstream(dimacs) << "p sp 2 1\na 1 3 5\n";
+    assert(throws([&]() { read_snap(snap, 2); }) && throws([&]() { read_dimacs(dimacs); }));
+    CsrGraph(3, std::vector<std::pair<int, int>>{{0, 1}, {1, 2}}).write(image);
+    std::string bytes;
+    {
+        std::ifstream in(image, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::uint64_t target_offset;    // field of the header after magic, version, weighted, n, m, offset_offset
+    std::memcpy(&target_offset, bytes.data() + 40, sizeof(target_offset));
+    int bad_target = 3;
+    std::memcpy(bytes.data() + target_offset, &bad_target, sizeof(bad_target));
+    std::ofstream(image, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    assert(throws([&]() { CsrGraph::open(image); }) && CsrGraph::open(image, false).edges() == 2);
+    std::ofstream(dimacs) << "a 1 2 5\n";
+    std::ofstream(image) << "not a graph image, just some text for the header";
+    assert(throws([&]() { read_dimacs(dimacs); }) && throws([&]() { CsrGraph::open(image); }));
+    assert(throws([&]() { read_snap((dir / "test_graph_loader.missing").string()); }));
+    std::ofstream(snap) << "# empty\n";
+    assert(read_snap(snap).vertices() == 0);
+    std::filesystem::remove(snap);
+    std::filesystem::remove(dimacs);
+    std::filesystem::remove(image);
+    std::cout << "Graph loader test: OK" << std::endl;
+}
+
 int main() {
     test_dwyer();
     test_edmonds_karp();
@@ -234,5 +442,7 @@ int main() {
     test_tree_hashing();
     test_scc();
     test_topological_sort();
+    test_csr_graph();
+    test_graph_loader();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,1207 @@
+#include "../structures/unordered_map.hpp"
+#include "../structures/flat_unordered_map.hpp"
+#include "../structures/frozen_unordered_map.hpp"
+#include "../structures/concurrent_unordered_map.hpp"
+#include "../structures/dary_heap.hpp"
+#include "../structures/double_linked_list.hpp"
+#include "../structures/heap.hpp"
+#include "../structures/indexed_heap.hpp"
+#include "../structures/interval_tree.hpp"
+#include "../structures/memory_pool.hpp"
+#include "../structures/mpsc_queue.hpp"
+#include "../structures/multi_queue.hpp"
+#include "../structures/pairing_heap.hpp"
+#include "../structures/persistent_interval_tree.hpp"
+#include "../structures/radix_heap.hpp"
+#include "../structures/rope.hpp"
+#include "../structures/spsc_ring_buffer.hpp"
+#include "../structures/unrolled_double_list.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <random>
+#include <set>
+#include <span>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+void test_unordered_map() {
+    UnorderedMap<long long, int> map;
+    UnorderedMap<long long, int> seeded_map(2024);
+    int n = 20000;
+    for (int i = 0; i < n; i++) {
+        map[(long long) i << 20] = i;
+        seeded_map.insert({(long long) i << 20, i});
+    }
+    std::size_t size = n;
+    assert(map.size() == size && seeded_map.size() == size);
+    assert(map.rehash_count < 16 && seeded_map.rehash_count < 16);
+    for (int i = 0; i < n; i++) {
+        assert(map.find((long long) i << 20)->second == i);
+        assert(seeded_map[(long long) i << 20] == i);
+    }
+    assert(map.find(1) == map.end());
+    UnorderedMap<long long, int> copy = map;
+    assert(copy.erase(0) == 1 && copy.size() == size - 1 && map.size() == size);
+    std::cout << "Unordered map test: OK" << std::endl;
+}
+
+void test_flat_unordered_map() {
+    FlatUnorderedMap<int, std::string> map;
+    int n = 10000;
+    std::size_t size = n;
+    for (int i = 0; i < n; i++) {
+        map.insert({i * 7, std::to_string(i)});
+    }
+    assert(map.size() == size);
+    for (int i = 0; i < n; i += 2) {
+        assert(map.erase(i * 7) == 1);
+    }
+    assert(map.erase(1) == 0);
+    map[3] = "three";
+    map[7] = "SEVEN";
+    assert(map.size() == size / 2 + 1);
+    assert(map.find(14) == map.end());
+    assert(map.find(21)->second == "3");
+    std::vector<int> order;
+    for (const auto & x : map) {
+        order.push_back(x.first);
+    }
+    assert(order.size() == map.size());
+    assert(order.front() == 7 && order.back() == 3);
+    for (std::size_t i = 1; i + 1 < order.size(); i++) {
+        assert(order[i] == order[i-1] + 14);
+    }
+    map.clear();
+    assert(map.size() == 0 && map.begin() == map.end());
+    for (int i = 0; i < n; i++) {
+        map.insert({i, std::to_string(i)});
+    }
+    for (auto it = map.begin(); it != map.end(); ) {
+        if (it->first % 3) {
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    assert(map.size() == (size + 2) / 3);
+    int expected = 0;
+    for (const auto & x : map) {
+        assert(x.first == expected && x.second == std::to_string(expected));
+        expected += 3;
+    }
+    for (int i = n; i < 50 * n; i++) {
+        map.insert({i, ""});
+        assert(map.erase(i - n) <= 1);
+    }
+    assert(map.size() == size && map.find(49 * n)->first == 49 * n);
+    std::cout << "Flat unordered map test: OK" << std::endl;
+}
+
+template <int Ways>
+double bucketized_max_load() {
+    FlatUnorderedMap<std::uint64_t, int, Ways> map;
+    std::mt19937_64 gen(17);
+    std::vector<std::uint64_t> keys;
+    double max_load = 0;
+    std::size_t buckets = map.bucket_count();
+    assert(std::has_single_bit(buckets));
+    for (int i = 0; i < 100000; i++) {
+        keys.push_back(gen());
+        double load = map.load_factor();
+        map[keys.back()] = i;
+        if (map.bucket_count() != buckets) {
+            max_load = std::max(max_load, load);
+            buckets = map.bucket_count();
+        }
+    }
+    assert(map.size() == keys.size());
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        assert(map.find(keys[i])->second == static_cast<int>(i));
+    }
+    return max_load;
+}
+
+void test_bucketized_unordered_map() {
+    assert(bucketized_max_load<1>() > 0.4);
+    assert(bucketized_max_load<2>() > 0.7);
+    assert(bucketized_max_load<3>() > 0.9);
+    assert(bucketized_max_load<4>() > 0.9);
+    assert(bucketized_max_load<5>() > 0.9);
+    assert(bucketized_max_load<6>() > 0.9);
+    assert(bucketized_max_load<7>() > 0.9);
+    assert(bucketized_max_load<8>() > 0.9);
+    std::cout << "Bucketized unordered map test: OK" << std::endl;
+}
+
+void test_incremental_unordered_map() {
+    FlatUnorderedMap<int, int, 4> map;
+    std::unordered_map<int, int> expected;
+    map.set_incremental(4);
+    std::mt19937 gen(7);
+    for (int i = 0; i < 200000; i++) {
+        int key = static_cast<int>(gen() % 50000);
+        if (gen() % 4 == 0) {
+            assert(map.erase(key) == expected.erase(key));
+        } else {
+            map[key] = i;
+            expected[key] = i;
+        }
+        int probe = static_cast<int>(gen() % 50000);
+        auto it = map.find(probe);
+        assert((it == map.end()) == (expected.find(probe) == expected.end()));
+        assert(it == map.end() || it->second == expected[probe]);
+    }
+    assert(map.size() == expected.size());
+    map.set_incremental(0);
+    for (auto & p : expected) {
+        assert(map.find(p.first)->second == p.second);
+    }
+    std::cout << "Incremental unordered map test: OK" << std::endl;
+}
+
+void test_concurrent_unordered_map() {
+    ConcurrentUnorderedMap<std::uint64_t, std::uint64_t> map;
+    int threads = 4;
+    std::uint64_t n = 20000;
+    std::atomic<bool> consistent = true;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (std::uint64_t i = t; i < n * threads; i += threads) {
+                map.insert(i, 3 * i);
+                auto value = map.find(i / 2);
+                consistent = consistent && (!value || *value == 3 * (i / 2));
+                if (i % 10 == 0) {
+                    map.erase(i);
+                }
+            }
+        });
+    }
+    for (auto & worker : workers) {
+        worker.join();
+    }
+    assert(consistent);
+    assert(map.size() == n * threads - n * threads / 10);
+    for (std::uint64_t i = 0; i < n * threads; i++) {
+        auto value = map.find(i);
+        assert(i % 10 == 0 ? !value : *value == 3 * i);
+    }
+    std::cout << "Concurrent unordered map test: OK" << std::endl;
+}
+
+void test_batch_lookup() {
+    UnorderedMap<int, int> map;
+    FlatUnorderedMap<int, int, 4> flat_map;
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 5000; i++) {
+        pairs.push_back({3 * i, i});
+    }
+    assert(map.insert_batch(pairs) == pairs.size());
+    assert(flat_map.insert_batch(pairs) == pairs.size());
+    assert(map.insert_batch(pairs) == 0);
+    std::vector<int> keys;
+    for (int i = 0; i < 15000; i++) {
+        keys.push_back(i);
+    }
+    std::vector<UnorderedMap<int, int>::Iterator> found(keys.size());
+    std::vector<FlatUnorderedMap<int, int, 4>::Iterator> flat_found(keys.size());
+    map.find_batch(keys, found);
+    flat_map.find_batch(keys, flat_found);
+    for (int i = 0; i < static_cast<int>(keys.size()); i++) {
+        assert(found[i] == map.find(i) && flat_found[i] == flat_map.find(i));
+        assert(i % 3 != 0 || (found[i]->second == i / 3 && flat_found[i]->second == i / 3));
+    }
+    std::cout << "Batch lookup test: OK" << std::endl;
+}
+
+void test_allocators() {
+    UnorderedMap<int, std::string, MultiplyShiftHash<int>, WyHash<int>,
+                 PoolAllocator<std::pair<int, std::string>>> map;
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 5000; i++) {
+            map[i] = std::to_string(i);
+        }
+        for (int i = 0; i < 5000; i += 2) {
+            assert(map.erase(i) == 1);
+        }
+        assert(map.size() == 2500 && map[4999] == "4999");
+        map.clear();
+        assert(map.size() == 0 && map.begin() == map.end());
+    }
+    auto copy = map;
+    copy[1] = "1";
+    assert(copy.size() == 1 && map.size() == 0);
+
+    DoubleList<int, ArenaAllocator<int>> list;
+    DoubleList<int, ArenaAllocator<int>> other;
+    for (int i = 0; i < 1000; i++) {
+        list.push_back(i);
+        other.push_front(i);
+    }
+    list.merge(other);
+    assert(other.empty());
+    int count = 0;
+    for (int x : list) {
+        assert(x == (count < 1000 ? count : 1999 - count));
+        count++;
+    }
+    assert(count == 2000);
+    list.destroy(list.pop_front());
+    list.clear();
+    assert(list.empty());
+
+    MonotonicArena arena;
+    DoubleList<std::string, ArenaAllocator<std::string>> shared1{ArenaAllocator<std::string>(arena)};
+    DoubleList<std::string, ArenaAllocator<std::string>> shared2{ArenaAllocator<std::string>(arena)};
+    shared1.push_back("a");
+    shared2.push_back("b");
+    shared1.merge(shared2);
+    assert(*shared1.begin() == "a" && shared2.empty());
+
+    Heap<int, std::less<int>, PoolAllocator<int>> heap;
+    for (int i = 0; i < 1000; i++) {
+        heap.insert((i * 37) % 1000);
+    }
+    for (int i = 999; i >= 0; i--) {
+        assert(heap.pop() == i);
+    }
+    std::cout << "Allocators test: OK" << std::endl;
+}
+
+void test_move_semantics() {
+    UnorderedMap<std::string, std::unique_ptr<int>> map;
+    for (int i = 0; i < 1000; i++) {
+        assert(map.try_emplace(std::to_string(i), std::make_unique<int>(i)).second);
+    }
+    assert(!map.try_emplace("7", std::make_unique<int>(-1)).second && *map["7"] == 7);
+    assert(!map.emplace("8", std::make_unique<int>(-1)).second && *map["8"] == 8);
+    map.insert({"8", std::make_unique<int>(-8)});
+    assert(*map["8"] == -8 && map["new"] == nullptr && map.size() == 1001);
+    auto moved = std::move(map);
+    assert(moved.size() == 1001 && *moved.find("999")->second == 999);
+    assert(map.size() == 0 && map.begin() == map.end());
+    map = std::move(moved);
+    assert(map.size() == 1001 && moved.size() == 0);
+
+    static_assert(std::is_nothrow_move_constructible_v<UnorderedMap<std::string, int>>);
+    static_assert(std::is_nothrow_move_constructible_v<DoubleList<std::string>>);
+    UnorderedMap<std::string, int> counts;
+    counts["a"] = 1;
+    UnorderedMap<std::string, int> taken(std::move(counts));
+    assert(counts.find("a") == counts.end() && counts.erase("a") == 0 && counts.begin() == counts.end());
+    counts["b"] = 2;
+    assert(counts.size() == 1 && counts["b"] == 2 && taken["a"] == 1);
+    std::vector<UnorderedMap<std::string, int>> maps(1);
+    maps[0]["key"] = 1;
+    const int* value = &maps[0].find("key")->second;
+    maps.resize(100);
+    assert(&maps[0].find("key")->second == value);
+
+    Heap<std::unique_ptr<int>, std::function<bool(const std::unique_ptr<int> &, const std::unique_ptr<int> &)>>
+        heap(1, [](const auto & a, const auto & b) { return *a > *b; });
+    for (int i = 0; i < 100; i++) {
+        heap.insert(std::make_unique<int>((i * 37) % 100));
+    }
+    heap.emplace(new int(-1));
+    auto heap2 = std::move(heap);
+    assert(heap.size() == 0 && heap2.size() == 101 && *heap2.top() == -1);
+    for (int i = -1; i < 100; i++) {
+        assert(*heap2.pop() == i);
+    }
+
+    DoubleList<std::unique_ptr<int>> list;
+    for (int i = 0; i < 10; i++) {
+        list.push_back(std::make_unique<int>(i));
+    }
+    list.emplace_front(new int(-1));
+    DoubleList<std::unique_ptr<int>> list2 = std::move(list);
+    assert(list.empty());
+    int expected = -1;
+    for (auto & x : list2) {
+        assert(*x == expected++);
+    }
+    list.push_back(std::make_unique<int>(5));
+    assert(!list.empty() && **list.begin() == 5);
+    std::cout << "Move semantics test: OK" << std::endl;
+}
+
+template <class List>
+void check_unrolled_double_list(std::mt19937 & gen) {
+    List list, other;
+    std::deque<int> expected, expected_other;
+    for (int i = 0; i < 20000; i++) {
+        int x = static_cast<int>(gen() % 1000);
+        switch (gen() % 10) {
+            case 0: case 1: case 2:
+                list.push_back(x);
+                expected.push_back(x);
+                break;
+            case 3: case 4:
+                list.push_front(x);
+                expected.push_front(x);
+                break;
+            case 5:
+                if (!expected.empty()) {
+                    assert(list.pop_front() == expected.front());
+                    expected.pop_front();
+                }
+                break;
+            case 6:
+                if (!expected.empty()) {
+                    assert(list.back() == expected.back() && list.pop_back() == expected.back());
+                    expected.pop_back();
+                }
+                break;
+            case 7:
+                list.reverse();
+                std::reverse(expected.begin(), expected.end());
+                break;
+            case 8:
+                if (x % 2) {
+                    other.push_back(x);
+                    expected_other.push_back(x);
+                } else {
+                    other.push_front(x);
+                    expected_other.push_front(x);
+                }
+                if (gen() % 4 == 0) {
+                    other.reverse();
+                    std::reverse(expected_other.begin(), expected_other.end());
+                }
+                break;
+            default:
+                if (gen() % 8 == 0) {
+                    list.merge(other);
+                    expected.insert(expected.end(), expected_other.begin(), expected_other.end());
+                    expected_other.clear();
+                    assert(other.empty());
+                }
+        }
+        assert(list.size() == expected.size());
+        if (i % 500 == 0) {
+            assert(std::equal(list.begin(), list.end(), expected.begin()));
+            assert(std::equal(other.begin(), other.end(), expected_other.begin()));
+        }
+    }
+    assert(std::equal(list.begin(), list.end(), expected.begin()));
+    list.clear();
+    assert(list.empty() && !(list.begin() != list.end()));
+}
+
+void test_unrolled_double_list() {
+    std::mt19937 gen(21);
+    check_unrolled_double_list<UnrolledDoubleList<int, std::allocator<int>, 1>>(gen);
+    check_unrolled_double_list<UnrolledDoubleList<int, std::allocator<int>, 3>>(gen);
+    check_unrolled_double_list<UnrolledDoubleList<int>>(gen);
+    check_unrolled_double_list<UnrolledDoubleList<int, ArenaAllocator<int>, 5>>(gen);
+
+    UnrolledDoubleList<std::string, ArenaAllocator<std::string>, 4> pooled;
+    MonotonicArena arena;
+    UnrolledDoubleList<std::string, ArenaAllocator<std::string>, 4> shared{ArenaAllocator<std::string>(arena)};
+    for (int i = 0; i < 10; i++) {
+        pooled.push_back(std::to_string(i));
+        shared.push_front(std::to_string(i));
+    }
+    pooled.merge(shared);
+    assert(shared.empty() && pooled.size() == 20 && pooled.back() == "0" && pooled.front() == "0");
+
+    UnrolledDoubleList<std::unique_ptr<int>> owners;
+    for (int i = 0; i < 300; i++) {
+        owners.emplace_back(new int(i));
+    }
+    auto moved = std::move(owners);
+    moved.reverse();
+    assert(owners.empty() && *moved.front() == 299 && *moved.pop_back() == 0);
+    int next = 299;
+    for (auto & x : moved) {
+        assert(*x == next--);
+    }
+    bool thrown = false;
+    try {
+        owners.pop_front();
+    } catch (const std::out_of_range &) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Unrolled double list test: OK" << std::endl;
+}
+
+void test_double_list_splice() {
+    std::mt19937 gen(22);
+    DoubleList<int> list;
+    std::list<int> expected;
+    auto check = [](DoubleList<int> & l, const std::list<int> & e) {
+        auto it = e.begin();
+        for (int x : l) {
+            assert(it != e.end() && x == *it++);
+        }
+        assert(it == e.end() && l.empty() == e.empty());
+    };
+    for (int i = 0; i < 2000; i++) {
+        DoubleList<int> other;
+        std::list<int> expected_other;
+        for (int k = static_cast<int>(gen() % 5); k > 0; k--) {
+            other.push_back(i * 10 + k);
+            expected_other.push_back(i * 10 + k);
+        }
+        if (gen() % 3 == 0) {
+            other.reverse();
+            expected_other.reverse();
+        }
+        std::size_t pos = gen() % (expected.size() + 1);
+        auto it = list.begin();
+        auto expected_it = expected.begin();
+        for (std::size_t k = 0; k < pos; k++) {
+            ++it;
+            ++expected_it;
+        }
+        if (gen() % 4 == 0) {
+            DoubleList<int> rest = list.split_at(it);
+            std::list<int> expected_rest;
+            expected_rest.splice(expected_rest.begin(), expected, expected_it, expected.end());
+            check(list, expected);
+            check(rest, expected_rest);
+            rest.reverse();
+            expected_rest.reverse();
+            list.merge(rest);
+            expected.splice(expected.end(), expected_rest);
+        } else {
+            list.splice(it, other);
+            expected.splice(expected_it, expected_other);
+            assert(other.empty());
+        }
+        if (gen() % 5 == 0) {
+            list.reverse();
+            expected.reverse();
+        }
+        if (i % 100 == 0) {
+            check(list, expected);
+        }
+    }
+    check(list, expected);
+    DoubleList<int> all = list.split_at(list.begin());
+    assert(list.empty());
+    check(all, expected);
+    std::cout << "Double list splice test: OK" << std::endl;
+}
+
+void test_rope() {
+    std::mt19937 gen(22);
+    std::vector<int> expected(1000);
+    for (int i = 0; i < 1000; i++) {
+        expected[i] = i;
+    }
+    Rope<int> rope(expected);
+    assert(rope.to_vector() == expected);
+    for (int i = 0; i < 5000; i++) {
+        std::size_t n = expected.size();
+        std::size_t l = gen() % (n + 1), r = gen() % (n + 1);
+        if (l > r) std::swap(l, r);
+        switch (gen() % 6) {
+            case 0: case 1:
+                rope.reverse(l, r);
+                std::reverse(expected.begin() + l, expected.begin() + r);
+                break;
+            case 2: {
+                Rope<int> rest = rope.split(l);
+                rest.reverse(0, rest.size());
+                rope.concat(rest);
+                assert(rest.empty());
+                std::reverse(expected.begin() + l, expected.end());
+                break;
+            }
+            case 3:
+                rope.insert(l, i);
+                expected.insert(expected.begin() + l, i);
+                break;
+            case 4:
+                if (l < n) {
+                    rope.erase(l);
+                    expected.erase(expected.begin() + l);
+                }
+                break;
+            default:
+                if (l < n) {
+                    assert(rope.at(l) == expected[l]);
+                    rope.at(l) = -i;
+                    expected[l] = -i;
+                }
+        }
+        assert(rope.size() == expected.size());
+        if (i % 250 == 0) {
+            assert(rope.to_vector() == expected);
+        }
+    }
+    assert(rope.to_vector() == expected);
+
+    Rope<std::string, PoolAllocator<std::string>> words, more;
+    for (int i = 0; i < 100; i++) {
+        words.push_back(std::to_string(i));
+        more.push_back(std::to_string(100 + i));
+    }
+    words.concat(more);
+    words.reverse(50, 150);
+    assert(words.size() == 200 && words.at(50) == "149" && words.at(149) == "50" && more.empty());
+    bool thrown = false;
+    try {
+        words.reverse(10, 201);
+    } catch (const std::out_of_range &) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Rope test: OK" << std::endl;
+}
+
+void test_spsc_ring_buffer() {
+    SpscRingBuffer<std::string> ring(5);
+    assert(ring.capacity() == 8 && ring.empty() && !ring.pop_front());
+    for (int i = 0; i < 8; i++) {
+        assert(ring.try_push_back(std::to_string(i)));
+    }
+    assert(!ring.try_push_back("full") && !ring.empty());
+    assert(ring.pop_front() == "0");
+    ring.push_back("8");
+    for (int i = 1; i <= 8; i++) {
+        assert(ring.pop_front() == std::to_string(i));
+    }
+    assert(ring.empty());
+    ring.push_back("left for the destructor");
+
+    SpscRingBuffer<int> queue(64);
+    int n = 200000;
+    std::thread producer([&queue, n]() {
+        for (int i = 0; i < n; i++) {
+            queue.push_back(i);
+        }
+    });
+    for (int i = 0; i < n; ) {
+        if (auto x = queue.pop_front()) {
+            assert(*x == i);
+            i++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    assert(queue.empty());
+    std::cout << "SPSC ring buffer test: OK" << std::endl;
+}
+
+void test_mpsc_queue() {
+    MpscQueue<std::string> words;
+    assert(words.empty() && words.pop_front() == nullptr);
+    words.push_back("a");
+    words.emplace_back(2, 'b');
+    words.push_back(words.create("c"));
+    std::string expected[] = { "a", "bb", "c" };
+    for (const std::string & word : expected) {
+        assert(!words.empty());
+        Node<std::string>* node = words.pop_front();
+        assert(node->name == word);
+        words.destroy(node);
+    }
+    assert(words.empty() && words.pop_front() == nullptr);
+    words.push_back("left for the destructor");
+
+    // every producer pushes its own numbers in increasing order
+    MpscQueue<int> queue;
+    int threads = 4, per_thread = 50000;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; t++) {
+        producers.emplace_back([&queue, t, threads, per_thread]() {
+            for (int i = 0; i < per_thread; i++) {
+                queue.push_back(i * threads + t);
+            }
+        });
+    }
+    std::vector<int> last(threads, -1);
+    for (int popped = 0; popped < threads * per_thread; ) {
+        Node<int>* node = queue.pop_front();
+        if (node == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        int t = node->name % threads;
+        assert(node->name / threads == last[t] + 1);
+        last[t]++;
+        queue.destroy(node);
+        popped++;
+    }
+    for (auto & p : producers) {
+        p.join();
+    }
+    assert(queue.empty() && queue.pop_front() == nullptr);
+    std::cout << "MPSC queue test: OK" << std::endl;
+}
+
+void test_transparent_lookup() {
+    UnorderedMap<std::string, int> map;
+    for (int i = 0; i < 1000; i++) {
+        map["key" + std::to_string(i)] = i;
+    }
+    std::string_view view = "key123";
+    assert(map.find(view)->second == 123 && map.find("key7")->second == 7);
+    assert(map.find(std::string_view("key")) == map.end());
+    assert(map.erase(view) == 1 && map.erase("key123") == 0 && map.find(view) == map.end());
+    map[std::string_view("key5")] += 10;
+    map["fresh"] = -1;
+    assert(map["key5"] == 15 && map.find(std::string("fresh"))->second == -1 && map.size() == 1000);
+    std::cout << "Transparent lookup test: OK" << std::endl;
+}
+
+void test_frozen_unordered_map() {
+    UnorderedMap<long long, double> map(7);
+    int n = 20000;
+    for (int i = 0; i < n; i++) {
+        map[(long long) i * 1000003] = i / 2.0;
+    }
+    auto image = FrozenUnorderedMap<long long, double>::freeze(map);
+    FrozenUnorderedMap<long long, double> view(image.data(), image.size() * sizeof(image[0]));
+    std::string path = (std::filesystem::temp_directory_path() / "test_frozen_unordered_map.bin").string();
+    FrozenUnorderedMap<long long, double>::write(map, path);
+    auto frozen = FrozenUnorderedMap<long long, double>::open(path);
+    std::size_t size = n;
+    assert(frozen.size() == size && view.size() == size && frozen.items().size() == size);
+    for (int i = 0; i < n; i++) {
+        assert(*frozen.find((long long) i * 1000003) == i / 2.0);
+        assert(view.at((long long) i * 1000003) == i / 2.0);
+    }
+    assert(frozen.find(1) == nullptr && !view.contains(1));
+    bool thrown = false;
+    try {
+        FrozenUnorderedMap<int, int> wrong = FrozenUnorderedMap<int, int>::open(path);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+    auto corrupted = image;
+    auto* words = reinterpret_cast<std::uint32_t*>(corrupted.data());
+    *std::find(words, words + corrupted.size() * sizeof(corrupted[0]) / 4, UINT32_MAX) = n;
+    thrown = false;
+    try {
+        FrozenUnorderedMap<long long, double> bad(corrupted.data(), corrupted.size() * sizeof(corrupted[0]));
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+    // an empty image shrunk to one slot per table, which would shift hashes by 64
+    UnorderedMap<long long, double> empty;
+    auto tiny = FrozenUnorderedMap<long long, double>::freeze(empty);
+    auto* header = reinterpret_cast<std::uint64_t*>(tiny.data());
+    header[4] = 1;                                  // capacity
+    header[6] = 64;                                 // shift
+    header[8] = header[7] + 64;                     // tab2_offset
+    header[9] = header[10] = header[8] + 64;        // entries_offset, image_size
+    thrown = false;
+    try {
+        FrozenUnorderedMap<long long, double> bad(tiny.data(), tiny.size() * sizeof(tiny[0]));
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+    UnorderedMap<int, double> padded;
+    for (int i = 0; i < 100; i++) {
+        padded[i] = i;
+    }
+    auto first = FrozenUnorderedMap<int, double>::freeze(padded);
+    auto second = FrozenUnorderedMap<int, double>::freeze(padded);
+    assert(std::memcmp(first.data(), second.data(), first.size() * sizeof(first[0])) == 0);
+    std::filesystem::remove(path);
+    std::cout << "Frozen unordered map test: OK" << std::endl;
+}
+
+void test_indexed_heap() {
+    IndexedHeap<int, std::greater<>> heap;
+    std::vector<int> handles;
+    for (int i = 0; i < 100; i++) {
+        handles.push_back(heap.insert(1000 + (i * 37) % 100));
+    }
+    heap.decrease_key(handles[50], 5);
+    assert(heap.top() == 5 && heap.top_handle() == handles[50]);
+    heap.erase(handles[50]);
+    assert(!heap.contains(handles[50]) && heap.size() == 99);
+    heap.update(handles[0], 2000);
+    heap.update(handles[1], 1);
+    bool thrown = false;
+    try {
+        heap.decrease_key(handles[2], 5000);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(heap.pop() == 1);
+    int last = 0;
+    while (heap.size() > 1) {
+        int x = heap.pop();
+        assert(x >= last);
+        last = x;
+    }
+    assert(heap.pop() == 2000 && heap.empty());
+    int h = heap.insert(3);
+    assert(heap.get(h) == 3 && heap.top() == 3);
+    std::cout << "Indexed heap test: OK" << std::endl;
+}
+
+template <int D>
+void check_dary_heap() {
+    DaryHeap<int, std::less<int>, D> heap;
+    std::multiset<int> expected;
+    std::mt19937 gen(D);
+    for (int i = 0; i < 5000; i++) {
+        if (gen() % 3 != 0 || expected.empty()) {
+            int x = static_cast<int>(gen() % 1000);
+            heap.insert(x);
+            expected.insert(x);
+        } else {
+            assert(heap.top() == *expected.rbegin());
+            assert(heap.pop() == *expected.rbegin());
+            expected.erase(std::prev(expected.end()));
+        }
+        assert(heap.size() == static_cast<int>(expected.size()));
+    }
+    DaryHeap<std::string, std::greater<>, D> strings;
+    for (int i = 0; i < 100; i++) {
+        strings.emplace(std::to_string(i));
+    }
+    assert(strings.pop() == "0" && strings.pop() == "1" && strings.pop() == "10");
+}
+
+void test_dary_heap() {
+    check_dary_heap<2>();
+    check_dary_heap<3>();
+    check_dary_heap<4>();
+    check_dary_heap<8>();
+    std::cout << "D-ary heap test: OK" << std::endl;
+}
+
+void test_heap_bulk() {
+    std::mt19937 gen(13);
+    std::vector<int> values(10000);
+    for (auto & x : values) {
+        x = static_cast<int>(gen() % 100000);
+    }
+    std::vector<int> sorted = values;
+    std::sort(sorted.begin(), sorted.end(), std::greater<>());
+
+    Heap<int> heap{std::vector<int>(values)};
+    assert(heap.size() == 10000 && heap.top() == sorted[0]);
+    auto top = heap.pop_n(3);
+    assert(top == std::vector<int>(sorted.begin(), sorted.begin() + 3));
+    top = heap.pop_n(5000);
+    assert(top == std::vector<int>(sorted.begin() + 3, sorted.begin() + 5003) && heap.size() == 4997);
+    assert(heap.pop() == sorted[5003]);
+
+    Heap<int> ranged(values.begin(), values.begin() + 100);
+    ranged.reserve(20000);
+    ranged.push_range(std::vector<int>(values.begin() + 100, values.end()));
+    ranged.push_range(std::vector<int>{1000000, -1});
+    assert(ranged.size() == 10002 && ranged.pop() == 1000000);
+    auto all = ranged.pop_n(20000);
+    assert(all.size() == 10001 && all.back() == -1 && ranged.size() == 0);
+    assert(std::equal(sorted.begin(), sorted.end(), all.begin()));
+
+    Heap<std::string, std::greater<>> strings;
+    std::vector<std::string> words = {"pear", "apple", "fig"};
+    strings.push_range(words);
+    assert(words[0] == "pear" && strings.pop() == "apple");
+    strings.push_range(std::span(words));
+    assert(words[1] == "apple" && strings.size() == 5 && strings.pop() == "apple");
+    assert(strings.pop_n(-1).empty() && strings.size() == 4);
+    std::cout << "Heap bulk operations test: OK" << std::endl;
+}
+
+void test_pairing_heap() {
+    std::mt19937 gen(14);
+    PairingHeap<int> a, b;
+    std::multiset<int> expected;
+    for (int i = 0; i < 5000; i++) {
+        int x = static_cast<int>(gen() % 1000);
+        (i % 2 == 0 ? a : b).insert(x);
+        expected.insert(x);
+    }
+    a.meld(b);
+    assert(a.size() == 5000 && b.empty());
+    std::vector<int> melded;
+    for (int i = 0; i < 2500; i++) {
+        int x = a.pop();
+        assert(x == *expected.rbegin());
+        expected.erase(std::prev(expected.end()));
+        if (i % 3 == 0) {
+            b.insert(x);
+            melded.push_back(x);
+        }
+    }
+    a.meld(b);
+    expected.insert(melded.begin(), melded.end());
+    assert(a.size() == static_cast<int>(expected.size()));
+    while (!a.empty()) {
+        assert(a.pop() == *expected.rbegin());
+        expected.erase(std::prev(expected.end()));
+    }
+
+    PairingHeap<std::unique_ptr<int>, std::function<bool(const std::unique_ptr<int>&, const std::unique_ptr<int>&)>> owning(
+            [](const std::unique_ptr<int> & x, const std::unique_ptr<int> & y) { return *x > *y; });
+    owning.emplace(new int(3));
+    owning.insert(std::make_unique<int>(1));
+    assert(*owning.top() == 1 && *owning.pop() == 1 && owning.size() == 1);
+
+    PairingHeap<int, std::less<>, PoolAllocator<int>> pooled, other;
+    pooled.insert(1);
+    other.insert(2);
+    pooled.meld(other);
+    assert(pooled.pop() == 2 && pooled.pop() == 1 && other.empty());
+    std::cout << "Pairing heap test: OK" << std::endl;
+}
+
+void test_radix_heap() {
+    std::mt19937 gen(14);
+    RadixHeap<std::uint32_t> heap;
+    std::multiset<std::uint32_t> expected;
+    std::uint32_t last = 0;
+    for (int i = 0; i < 20000; i++) {
+        if (expected.empty() || gen() % 3 != 0) {
+            std::uint32_t x = last + static_cast<std::uint32_t>(gen() % (i % 100 == 0 ? 1000000 : 100));
+            heap.insert(x);
+            expected.insert(x);
+        } else {
+            assert(heap.top() == *expected.begin());
+            last = heap.pop();
+            assert(last == *expected.begin());
+            expected.erase(expected.begin());
+        }
+    }
+    assert(heap.size() == static_cast<int>(expected.size()));
+    bool thrown = false;
+    try {
+        heap.insert(last - 1);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    RadixHeap<std::pair<long long, std::string>, FirstKey> pairs;
+    pairs.emplace(5, "five");
+    pairs.emplace(0x7fffffffffffLL, "big");
+    pairs.emplace(2, "two");
+    assert(pairs.pop().second == "two" && pairs.pop().second == "five");
+    pairs.emplace(5, "again");
+    assert(pairs.pop().second == "again" && pairs.pop().second == "big" && pairs.empty());
+    std::cout << "Radix heap test: OK" << std::endl;
+}
+
+void test_multi_queue() {
+    MultiQueue<int> queue(4);
+    assert(queue.queues_count() == 8 && queue.empty() && !queue.try_pop());
+    int threads = 4, per_thread = 20000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&queue, t, per_thread]() {
+            for (int i = 0; i < per_thread; i++) {
+                queue.insert(t * per_thread + i);
+            }
+        });
+    }
+    for (auto & w : workers) {
+        w.join();
+    }
+    assert(queue.size() == threads * per_thread);
+
+    std::vector<std::vector<int>> popped(threads);
+    workers.clear();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&queue, &popped, t]() {
+            while (auto x = queue.try_pop()) {
+                popped[t].push_back(*x);
+            }
+        });
+    }
+    for (auto & w : workers) {
+        w.join();
+    }
+    std::vector<int> all;
+    for (auto & p : popped) {
+        all.insert(all.end(), p.begin(), p.end());
+    }
+    std::sort(all.begin(), all.end());
+    assert(static_cast<int>(all.size()) == threads * per_thread && queue.empty());
+    for (int i = 0; i < threads * per_thread; i++) {
+        assert(all[i] == i);
+    }
+
+    // with one thread, the pops only deviate from the order by the sampling
+    MultiQueue<int, std::greater<>> relaxed(1, 2);
+    for (int i = 0; i < 1000; i++) {
+        relaxed.emplace(i);
+    }
+    int first = relaxed.pop();
+    assert(first < 100);
+    bool thrown = false;
+    try {
+        MultiQueue<int> invalid(4, 0);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "MultiQueue test: OK" << std::endl;
+}
+
+/**
+ * Sum, length and first element of a range; the first element makes
+ * + non-commutative, so the tests check the order of the operands
+ */
+struct RangeValue {
+    long long sum = 0, len = 0, first = 0;
+
+    RangeValue operator+(const RangeValue & other) const {
+        if (len == 0) return other;
+        if (other.len == 0) return *this;
+        return {sum + other.sum, len + other.len, first};
+    }
+};
+
+/**
+ * x -> a*x + b modulo a small prime; m1 * m2 applies m2 first
+ */
+struct AffineModifier {
+    static constexpr long long MOD = 1000003;
+    long long a = 1, b = 0;
+
+    AffineModifier operator*(const AffineModifier & other) const {
+        return {a * other.a % MOD, (a * other.b + b) % MOD};
+    }
+    RangeValue operator()(const RangeValue & v) const {
+        if (v.len == 0) return v;
+        return {(a * v.sum + b * v.len) % MOD, v.len, (a * v.first + b) % MOD};
+    }
+};
+
+template <class Tree>
+void check_interval_tree(Tree & tree, std::vector<long long> & values, int operations, std::mt19937 & gen) {
+    int n = static_cast<int>(values.size());
+    for (int i = 0; i < operations; i++) {
+        int begin = static_cast<int>(gen() % (n + 1)), end = static_cast<int>(gen() % (n + 1));
+        if (begin > end) std::swap(begin, end);
+        if (gen() % 2 == 0) {
+            AffineModifier m{static_cast<long long>(gen() % 5), static_cast<long long>(gen() % 7)};
+            tree.update(begin, end, m);
+            for (int j = begin; j < end; j++) {
+                values[j] = (m.a * values[j] + m.b) % AffineModifier::MOD;
+            }
+        } else {
+            RangeValue v = tree.query(begin, end);
+            long long sum = 0;
+            for (int j = begin; j < end; j++) {
+                sum += values[j];
+            }
+            assert(v.len == end - begin && v.sum % AffineModifier::MOD == sum % AffineModifier::MOD);
+            assert(begin == end || v.first == values[begin]);
+        }
+    }
+}
+
+template <class Tree>
+void check_interval_tree_batches(Tree & tree, std::vector<long long> & values, int threads, std::mt19937 & gen) {
+    int n = static_cast<int>(values.size());
+    auto random_range = [&gen, n]() {
+        std::size_t begin = gen() % (n + 1), end = gen() % (n + 1);
+        return std::make_pair(std::min(begin, end), std::max(begin, end));
+    };
+    for (int round = 0; round < 20; round++) {
+        std::vector<typename Tree::RangeUpdate> updates(gen() % 50);
+        for (auto & u : updates) {
+            auto [begin, end] = random_range();
+            u = {begin, end, AffineModifier{static_cast<long long>(gen() % 5), static_cast<long long>(gen() % 7)}};
+            for (std::size_t j = begin; j < end; j++) {
+                values[j] = (u.modifier.a * values[j] + u.modifier.b) % AffineModifier::MOD;
+            }
+        }
+        tree.update_batch(updates, threads);
+        std::vector<std::pair<std::size_t, std::size_t>> ranges(gen() % 50);
+        for (auto & range : ranges) {
+            range = random_range();
+        }
+        std::vector<RangeValue> results(ranges.size());
+        tree.query_batch(ranges, results, threads);
+        for (std::size_t i = 0; i < ranges.size(); i++) {
+            auto [begin, end] = ranges[i];
+            long long sum = 0;
+            for (std::size_t j = begin; j < end; j++) {
+                sum += values[j];
+            }
+            assert(results[i].len == static_cast<long long>(end - begin));
+            assert(results[i].sum % AffineModifier::MOD == sum % AffineModifier::MOD);
+            assert(begin == end || results[i].first == values[begin]);
+        }
+    }
+}
+
+template <TreeLayout Layout, std::size_t LeafSize = 1>
+void check_interval_tree_layout(std::mt19937 & gen) {
+    for (int n : {1, 2, 7, 8, 13, 100, 20000}) {
+        std::vector<RangeValue> initial(n);
+        std::vector<long long> values(n);
+        for (int i = 0; i < n; i++) {
+            values[i] = static_cast<long long>(gen() % 100);
+            initial[i] = {values[i], 1, values[i]};
+        }
+        IntervalTree<RangeValue, AffineModifier, Layout, LeafSize> tree(initial, n % 2 ? 1 : 3);
+        check_interval_tree(tree, values, 2000, gen);
+        check_interval_tree_batches(tree, values, 1, gen);
+        check_interval_tree_batches(tree, values, 3, gen);
+        check_interval_tree(tree, values, 200, gen);
+    }
+    IntervalTree<RangeValue, AffineModifier, Layout, LeafSize> filled(5, RangeValue{3, 1, 3}, 2);
+    assert(filled.query(1, 4).sum == 9 && filled.query(2, 2).len == 0);
+}
+
+/**
+ * Multiplication modulo 2^64 of arithmetic values, summed by plain +
+ */
+struct ScaleModifier {
+    std::uint64_t c = 1;
+
+    ScaleModifier operator*(const ScaleModifier & other) const {
+        return {c * other.c};
+    }
+    std::uint64_t operator()(std::uint64_t v) const {
+        return c * v;
+    }
+};
+
+template <TreeLayout Layout, std::size_t LeafSize>
+void check_interval_tree_sums(std::mt19937 & gen) {
+    for (int n : {1, 5, 16, 17, 100, 40000}) {
+        std::vector<std::uint64_t> values(n);
+        for (auto & v : values) {
+            v = gen();
+        }
+        IntervalTree<std::uint64_t, ScaleModifier, Layout, LeafSize> tree(values, 2);
+        for (int i = 0; i < 2000; i++) {
+            std::size_t begin = gen() % (n + 1), end = gen() % (n + 1);
+            if (begin > end) std::swap(begin, end);
+            if (gen() % 2 == 0) {
+                ScaleModifier m{gen() % 7};
+                tree.update(begin, end, m);
+                for (std::size_t j = begin; j < end; j++) {
+                    values[j] *= m.c;
+                }
+            } else {
+                std::uint64_t sum = 0;
+                for (std::size_t j = begin; j < end; j++) {
+                    sum += values[j];
+                }
+                assert(tree.query(begin, end) == sum);
+            }
+        }
+    }
+}
+
+void test_interval_tree() {
+    std::mt19937 gen(16);
+    check_interval_tree_layout<TreeLayout::Perfect>(gen);
+    check_interval_tree_layout<TreeLayout::Compact>(gen);
+    check_interval_tree_layout<TreeLayout::VanEmdeBoas>(gen);
+    check_interval_tree_layout<TreeLayout::Perfect, 4>(gen);
+    check_interval_tree_layout<TreeLayout::Compact, 3>(gen);
+    check_interval_tree_layout<TreeLayout::VanEmdeBoas, 8>(gen);
+    check_interval_tree_sums<TreeLayout::Perfect, 8>(gen);
+    check_interval_tree_sums<TreeLayout::Compact, 16>(gen);
+    check_interval_tree_sums<TreeLayout::VanEmdeBoas, 12>(gen);
+    assert((IntervalTree<RangeValue, AffineModifier>(8).nodes() == 16));
+    assert((IntervalTree<RangeValue, AffineModifier>(9).nodes() == 32));
+    assert((IntervalTree<RangeValue, AffineModifier, TreeLayout::Compact>(9).nodes() == 18));
+    assert((IntervalTree<std::uint64_t, ScaleModifier, TreeLayout::Perfect, 16>(1000).nodes() == 128));
+    std::cout << "Interval tree test: OK" << std::endl;
+}
+
+void test_persistent_interval_tree() {
+    std::mt19937 gen(19);
+    for (int n : {1, 2, 7, 13, 100}) {
+        std::vector<RangeValue> initial(n);
+        std::vector<std::vector<long long>> snapshots(1, std::vector<long long>(n));
+        for (int i = 0; i < n; i++) {
+            snapshots[0][i] = static_cast<long long>(gen() % 100);
+            initial[i] = {snapshots[0][i], 1, snapshots[0][i]};
+        }
+        PersistentIntervalTree<RangeValue, AffineModifier> tree(initial);
+        int updates = 300;
+        for (int i = 0; i < updates; i++) {
+            std::size_t version = gen() % tree.versions();
+            int begin = static_cast<int>(gen() % (n + 1)), end = static_cast<int>(gen() % (n + 1));
+            if (begin > end) std::swap(begin, end);
+            AffineModifier m{static_cast<long long>(gen() % 5), static_cast<long long>(gen() % 7)};
+            assert(tree.update(version, begin, end, m) == snapshots.size());
+            std::vector<long long> values = snapshots[version];
+            for (int j = begin; j < end; j++) {
+                values[j] = (m.a * values[j] + m.b) % AffineModifier::MOD;
+            }
+            snapshots.push_back(values);
+        }
+        for (int i = 0; i < 2000; i++) {
+            std::size_t version = gen() % tree.versions();
+            int begin = static_cast<int>(gen() % (n + 1)), end = static_cast<int>(gen() % (n + 1));
+            if (begin > end) std::swap(begin, end);
+            RangeValue v = tree.query(version, begin, end);
+            long long sum = 0;
+            for (int j = begin; j < end; j++) {
+                sum += snapshots[version][j];
+            }
+            assert(v.len == end - begin && v.sum % AffineModifier::MOD == sum % AffineModifier::MOD);
+            assert(begin == end || v.first == snapshots[version][begin]);
+        }
+        // O(n + u log n) nodes instead of a copy of the tree per version
+        int log = std::bit_width(static_cast<unsigned>(n));
+        assert(tree.nodes() <= static_cast<std::size_t>(2 * n + updates * 4 * (log + 1)));
+    }
+    PersistentIntervalTree<RangeValue, AffineModifier> tree(4, RangeValue{2, 1, 2});
+    bool thrown = false;
+    try {
+        tree.query(1, 0, 4);
+    } catch (const std::out_of_range &) {
+        thrown = true;
+    }
+    assert(thrown && tree.query(0, 0, 4).sum == 8);
+    std::cout << "Persistent interval tree test: OK" << std::endl;
+}
+
+int main() {
+    test_unordered_map();
+    test_flat_unordered_map();
+    test_bucketized_unordered_map();
+    test_incremental_unordered_map();
+    test_concurrent_unordered_map();
+    test_batch_lookup();
+    test_allocators();
+    test_move_semantics();
+    test_unrolled_double_list();
+    test_double_list_splice();
+    test_rope();
+    test_spsc_ring_buffer();
+    test_mpsc_queue();
+    test_transparent_lookup();
+    test_frozen_unordered_map();
+    test_indexed_heap();
+    test_dary_heap();
+    test_heap_bulk();
+    test_pairing_heap();
+    test_radix_heap();
+    test_multi_queue();
+    test_interval_tree();
+    test_persistent_interval_tree();
+    return 0;
+}